@@ -0,0 +1,264 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/Network.hpp"
+#include "../src/Current.hpp"
+#include "../src/Config.hpp"
+#include "../src/Sweep.hpp"
+
+namespace {
+
+	/// A regime of the network, one of the simulations of results/
+	struct Regime {
+		double eta, g;
+	};
+
+	/// The four regimes of Brunel (2000): synchronous regular, asynchronous irregular,
+	/// and the fast and slow synchronous irregular oscillations
+	const Regime REGIMES[] = { { 2.0, 3.0 }, { 2.0, 5.0 }, { 4.0, 6.0 }, { 0.9, 4.5 } };
+
+	/// Names of the measures, in order
+	const char* MEASURES[] = { "construction_s", "run_s", "steps_per_s", "neuron_updates_per_s", "synaptic_events_per_s" };
+	const int N_MEASURES = sizeof(MEASURES) / sizeof(MEASURES[0]);
+
+	/// Statistics of the repetitions of one measure
+	struct Summary {
+		double mean, stddev, min, max;
+	};
+
+	/// Result of one scenario: a regime at one size
+	struct Result {
+		double eta, g;
+		int nNeurons;
+		long nSpikes;				//!< spikes of the last repetition
+		double rate;				//!< mean firing rate of the last repetition, in Hz
+		Summary measures[N_MEASURES];
+	};
+
+	/// Options of the benchmark itself, the other flags are simulation parameters
+	struct Options {
+		std::string sizes = "2500,12500";	//!< numbers of neurons, see Sweep::parseGrid()
+		int repetitions = 3;				//!< simulations of every scenario
+		std::string report = "csv";			//!< format of the results, "csv" or "json"
+		std::string reportFile = "";		//!< file of the results, standard output if empty
+	};
+
+	/// Get the statistics of the values of a measure
+	Summary summarise(const std::vector<double>& values) {
+		Summary summary = { 0.0, 0.0, values[0], values[0] };
+
+		for (double value : values) {
+			summary.mean += value;
+			summary.min = std::min(summary.min, value);
+			summary.max = std::max(summary.max, value);
+		}
+		summary.mean /= values.size();
+
+		// sample standard deviation, 0 for a single repetition
+		for (double value : values) {
+			summary.stddev += (value - summary.mean) * (value - summary.mean);
+		}
+		summary.stddev = values.size() > 1 ? std::sqrt(summary.stddev / (values.size() - 1)) : 0.0;
+
+		return summary;
+	}
+
+	/// Take the benchmark options out of the flags, --key=value or --key value
+	std::vector<char*> parseOptions(int argc, char** argv, Options& options) {
+		std::vector<char*> rest(1, argv[0]);
+
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			std::string key = arg.substr(0, arg.find('='));
+			std::string value;
+
+			if (key != "--sizes" && key != "--repetitions" && key != "--report" && key != "--report_file") {
+				rest.push_back(argv[i]);
+				continue;
+			}
+
+			if (key.size() < arg.size()) {
+				value = arg.substr(key.size() + 1);
+			} else if (i + 1 < argc) {
+				value = argv[++i];
+			} else {
+				throw std::invalid_argument("missing value for '" + arg + "'");
+			}
+
+			if (key == "--sizes") {
+				options.sizes = value;
+			} else if (key == "--repetitions") {
+				std::istringstream in(value);
+				if (!(in >> options.repetitions) || !(in >> std::ws).eof() || options.repetitions < 1)
+					throw std::invalid_argument("invalid value '" + value + "' for 'repetitions'");
+			} else if (key == "--report") {
+				if (value != "csv" && value != "json")
+					throw std::invalid_argument("invalid value '" + value + "' for 'report', expected csv or json");
+				options.report = value;
+			} else {
+				options.reportFile = value;
+			}
+		}
+
+		return rest;
+	}
+
+	/// Simulate one scenario several times
+	Result measure(const Config& config, int repetitions) {
+		typedef std::chrono::steady_clock Clock;
+
+		const long steps = std::abs(config.duration);
+		const double nNeurons = config.getNbNeurons();
+		std::vector<std::vector<double>> values(N_MEASURES);
+
+		Result result = { config.eta, config.g, config.getNbNeurons(), 0, 0.0, {} };
+
+		for (int k = 0; k < repetitions; ++k) {
+			Current current(0.0, 0, 0);
+
+			// the connections are drawn again for every repetition, unless cached
+			const Clock::time_point t0 = Clock::now();
+			Network network(&current, config);
+			const Clock::time_point t1 = Clock::now();
+			network.run();
+			const Clock::time_point t2 = Clock::now();
+
+			const double construction = std::chrono::duration<double>(t1 - t0).count();
+			const double run = std::chrono::duration<double>(t2 - t1).count();
+
+			values[0].push_back(construction);
+			values[1].push_back(run);
+			values[2].push_back(steps / run);
+			values[3].push_back(nNeurons * steps / run);
+			values[4].push_back(network.getNbSynapticEvents() / run);
+
+			result.nSpikes = network.getStatistics().getNbSpikes();
+			result.rate = network.getStatistics().getRate();
+		}
+
+		for (int i = 0; i < N_MEASURES; ++i) {
+			result.measures[i] = summarise(values[i]);
+		}
+		return result;
+	}
+
+	/// Write the results as a table, one scenario per line
+	void writeCsv(std::ostream& out, const Config& config, const std::vector<Result>& results, int repetitions) {
+		out << "eta,g,neurons,threads,steps,repetitions,spikes,rate";
+		for (const char* name : MEASURES) {
+			out << ',' << name << "_mean," << name << "_stddev," << name << "_min," << name << "_max";
+		}
+		out << '\n';
+
+		for (const Result& result : results) {
+			out << result.eta << ',' << result.g << ',' << result.nNeurons << ',' << config.nThreads << ',' <<
+				std::abs(config.duration) << ',' << repetitions << ',' << result.nSpikes << ',' << result.rate;
+			for (const Summary& summary : result.measures) {
+				out << ',' << summary.mean << ',' << summary.stddev << ',' << summary.min << ',' << summary.max;
+			}
+			out << '\n';
+		}
+	}
+
+	/// Write the results as a JSON array, one object per scenario
+	void writeJson(std::ostream& out, const Config& config, const std::vector<Result>& results, int repetitions) {
+		out << "[\n";
+		for (std::size_t k = 0; k < results.size(); ++k) {
+			const Result& result = results[k];
+
+			out << "  {\"eta\": " << result.eta << ", \"g\": " << result.g << ", \"neurons\": " << result.nNeurons <<
+				", \"threads\": " << config.nThreads << ", \"steps\": " << std::abs(config.duration) <<
+				", \"repetitions\": " << repetitions << ", \"spikes\": " << result.nSpikes << ", \"rate\": " << result.rate;
+
+			for (int i = 0; i < N_MEASURES; ++i) {
+				const Summary& summary = result.measures[i];
+				out << ",\n   \"" << MEASURES[i] << "\": {\"mean\": " << summary.mean << ", \"stddev\": " << summary.stddev <<
+					", \"min\": " << summary.min << ", \"max\": " << summary.max << "}";
+			}
+			out << '}' << (k + 1 < results.size() ? "," : "") << '\n';
+		}
+		out << "]\n";
+	}
+}
+
+// measures the simulation of the four regimes at several sizes
+int main(int argc, char** argv) {
+
+	// a shorter simulation than the default, without writing the spikes
+	Config config;
+	config.nThreads = std::max(1u, std::thread::hardware_concurrency());
+	config.duration = 2000;
+	config.recordSpikes = false;
+	config.verbose = false;
+
+	Options options;
+	std::vector<double> sizes;
+
+	try {
+		std::vector<char*> rest = parseOptions(argc, argv, options);
+		if (!config.parse(rest.size(), rest.data())) {
+			std::cout << "  --sizes\tnumbers of neurons, 4:1 excitatory to inhibitory (" << options.sizes << ")" << std::endl;
+			std::cout << "  --repetitions\tsimulations of every scenario (" << options.repetitions << ")" << std::endl;
+			std::cout << "  --report\tformat of the results, csv or json (" << options.report << ")" << std::endl;
+			std::cout << "  --report_file\tfile of the results, standard output if empty" << std::endl;
+			return 0;
+		}
+
+		sizes = Sweep::parseGrid(options.sizes);
+		for (double size : sizes) {
+			if (size < 1 || size != std::floor(size))
+				throw std::invalid_argument("invalid size " + std::to_string(size) + ", expected a number of neurons");
+		}
+		config.validate();
+	} catch (const std::invalid_argument& error) {
+		std::cerr << "Error: " << error.what() << std::endl;
+		return 1;
+	}
+
+	// every regime at every size, the progress on the error stream
+	std::vector<Result> results;
+
+	for (const Regime& regime : REGIMES) {
+		for (double size : sizes) {
+			Config scenario = config;
+			scenario.eta = regime.eta;
+			scenario.g = regime.g;
+			scenario.nExcitatory = (int) size * 4 / 5;
+			scenario.nInhibitory = (int) size - scenario.nExcitatory;
+
+			results.push_back(measure(scenario, options.repetitions));
+
+			const Result& result = results.back();
+			std::cerr << "eta " << regime.eta << ", g " << regime.g << ", " << result.nNeurons << " neurons:" << '\t' <<
+				result.measures[0].mean << " s to build, " << result.measures[1].mean << " s to run, " <<
+				result.measures[3].mean << " neuron updates/s, " << result.measures[4].mean << " synaptic events/s, " <<
+				result.rate << " Hz" << std::endl;
+		}
+	}
+
+	// write the results
+	std::ofstream file;
+	if (!options.reportFile.empty()) {
+		file.open(options.reportFile);
+		if (!file) {
+			std::cerr << "Error: cannot write the report '" << options.reportFile << "'" << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = options.reportFile.empty() ? std::cout : file;
+
+	if (options.report == "json") {
+		writeJson(out, config, results, options.repetitions);
+	} else {
+		writeCsv(out, config, results, options.repetitions);
+	}
+
+	return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/** \brief Allocator returning memory aligned on a fixed boundary
+ *
+ * Used for the hot simulation arrays, so that they start on a cache line
+ * and can be processed with aligned vector loads.
+ * */
+template<typename T, std::size_t ALIGNMENT = 64>
+class AlignedAllocator {
+
+public:
+	typedef T value_type;
+
+	/// Rebind helper, needed because of the non-type template parameter
+	template<typename U>
+	struct rebind {
+		typedef AlignedAllocator<U, ALIGNMENT> other;
+	};
+
+	/// Default constructor
+	AlignedAllocator() noexcept {}
+
+	/// Converting constructor, the allocator is stateless
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>&) noexcept {}
+
+	/// Allocate aligned memory for \p n elements
+	T* allocate(std::size_t n) {
+		void* ptr = nullptr;
+
+		if (posix_memalign(&ptr, ALIGNMENT, n * sizeof(T)) != 0) {
+			throw std::bad_alloc();
+		}
+
+		return static_cast<T*>(ptr);
+	}
+
+	/// Release memory obtained through allocate()
+	void deallocate(T* ptr, std::size_t) noexcept {
+		free(ptr);
+	}
+};
+
+template<typename T, typename U, std::size_t ALIGNMENT>
+bool operator==(const AlignedAllocator<T, ALIGNMENT>&, const AlignedAllocator<U, ALIGNMENT>&) {
+	return true;
+}
+
+template<typename T, typename U, std::size_t ALIGNMENT>
+bool operator!=(const AlignedAllocator<T, ALIGNMENT>&, const AlignedAllocator<U, ALIGNMENT>&) {
+	return false;
+}
+
+/// std::vector whose storage starts on a cache line
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+#endif
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include "BackgroundNoise.hpp"
+
+namespace {
+	/// Number of neurons whose random words are generated at once
+	constexpr int BATCH = 256;
+}
+
+BackgroundNoise::BackgroundNoise(uint64_t s, double lambda, double jExt)
+	: seed(s), generator(s),
+	  sampler(lambda), j(jExt)
+{}
+
+// get the seed
+uint64_t BackgroundNoise::getSeed() const {
+	return seed;
+}
+
+// add the noise of a range of neurons to their input
+void BackgroundNoise::add(int first, int last, long time, double* input, int offset) const {
+	uint32_t u[BATCH], extra[BATCH];
+	int counts[BATCH];
+
+	const uint32_t timeLow = (uint32_t) time;
+	const uint32_t timeHigh = (uint32_t) ((uint64_t) time >> 32);
+
+	for (int batch = first; batch < last; batch += BATCH) {
+		const int n = std::min(BATCH, last - batch);
+
+		// random words of the whole batch, then their spike counts
+		for (int i = 0; i < n; ++i) {
+			Philox::Block bits = generator(batch + i, timeLow, timeHigh, Stream::NOISE);
+			u[i] = bits.v[0];
+			extra[i] = bits.v[1];
+		}
+
+		sampler.sample(n, u, extra, counts);
+
+		for (int i = 0; i < n; ++i) {
+			input[batch - offset + i] += counts[i] * j;
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef BACKGROUND_NOISE_H
+#define BACKGROUND_NOISE_H
+
+#include <cstdint>
+#include "Philox.hpp"
+#include "PoissonSampler.hpp"
+#include "Constants.hpp"
+
+/** \brief Random background input from the external neurons
+ *
+ * Every neuron receives a Poisson distributed number of external spikes
+ * per step, each one carrying the excitatory transmission value. The draw of a neuron at a step
+ * only depends on the seed, the neuron index and the step, so the same seed
+ * gives the same noise whatever the order of the draws or the number of threads.
+ * */
+class BackgroundNoise {
+
+public:
+	/*! \brief BackgroundNoise constructor
+	 *
+	 * \param seed		seed of the random streams
+	 * \param lambda	mean number of external spikes per step
+	 * \param j			potential carried by one external spike
+	 */
+	explicit BackgroundNoise(uint64_t seed = C::SEED, double lambda = C::V_EXT * C::STEP_DURATION,
+							 double j = C::J_EXCITATORY);
+
+	/// Get the seed of the random streams
+	uint64_t getSeed() const;
+
+	/// Get the number of external spikes received by neuron \p idx at step \p time
+	int getNbSpikes(int idx, long time) const {
+		Philox::Block bits = generator(idx, (uint32_t) time, (uint32_t) ((uint64_t) time >> 32), Stream::NOISE);
+		return sampler(bits.v[0], bits.v[1]);
+	}
+
+	/// Get the background noise of neuron \p idx at step \p time
+	double get(int idx, long time) const {
+		return getNbSpikes(idx, time) * j;
+	}
+
+	/*! \brief Add the background noise of a range of neurons
+	 *
+	 * \param first		index of the first neuron
+	 * \param last		index after the last neuron
+	 * \param time		the step, seen from the simulation clock
+	 * \param input		the input of the neurons, indexed from neuron \p offset
+	 * \param offset	index of the neuron of the first element of \p input
+	 */
+	void add(int first, int last, long time, double* input, int offset = 0) const;
+
+private:
+
+	uint64_t seed;				//!< seed of the random streams
+	Philox generator;			//!< counter-based generator, keyed with the seed
+
+	PoissonSampler sampler;		//!< number of spikes per step
+	double j;					//!< potential carried by one spike
+};
+
+#endif
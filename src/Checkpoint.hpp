@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstdint>
+
+/** \brief Layout of the checkpoint files, see Network::checkpoint()
+ *
+ * A header, then the state of every part of the network, each one
+ * written by its own save() method with the functions below, in native byte order.
+ * Reading past the end of the file raises std::runtime_error.
+ * */
+namespace Checkpoint {
+
+	/// Start of the file
+	struct Header {
+		char magic[8];				//!< identifies the file
+		uint32_t version;			//!< version of the format
+		uint32_t byteOrder;			//!< ENDIANNESS as written, to detect other architectures
+		uint64_t modelHash;			//!< Config::getModelHash() of the network
+		uint64_t connectionsHash;	//!< Config::getConnectionsHash() of its connections
+		int64_t step;				//!< step at which the simulation resumes
+		uint64_t nNeurons;			//!< number of neurons
+		int64_t outputSize;			//!< size of the streamed result file, in bytes, -1 if none
+		uint64_t reserved;			//!< pads the header to a cache line
+	};
+
+	constexpr char MAGIC[8] = { 'B', 'R', 'U', 'N', 'E', 'L', 'C', 'K' };
+	constexpr uint32_t VERSION = 2;
+	constexpr uint32_t ENDIANNESS = 0x01020304;
+
+	/// Write the bytes of a value
+	template<typename T>
+	void write(std::ostream& out, const T& value) {
+		out.write((const char*) &value, sizeof(T));
+	}
+
+	/// Read the bytes of a value
+	template<typename T>
+	void read(std::istream& in, T& value) {
+		if (!in.read((char*) &value, sizeof(T)))
+			throw std::runtime_error("the checkpoint is truncated");
+	}
+
+	/// Write the size and the elements of a vector
+	template<typename V>
+	void writeArray(std::ostream& out, const V& values) {
+		const uint64_t n = values.size();
+		write(out, n);
+		out.write((const char*) values.data(), n * sizeof(typename V::value_type));
+	}
+
+	/// Read a vector written by writeArray(), of \p expected elements unless negative
+	template<typename V>
+	void readArray(std::istream& in, V& values, long expected = -1) {
+		uint64_t n;
+		read(in, n);
+		if (expected >= 0 && n != (uint64_t) expected)
+			throw std::runtime_error("the checkpoint does not match the network");
+
+		values.resize(n);
+		if (!in.read((char*) values.data(), n * sizeof(typename V::value_type)))
+			throw std::runtime_error("the checkpoint is truncated");
+	}
+}
+
+#endif
@@ -0,0 +1,308 @@
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include "Config.hpp"
+
+namespace {
+
+	/// Parse a whole string as a value of type T
+	template<typename T>
+	T parseValue(const std::string& key, const std::string& text) {
+		std::istringstream in(text);
+		T value;
+
+		if (!(in >> value) || !(in >> std::ws).eof()) {
+			throw std::invalid_argument("invalid value '" + text + "' for parameter '" + key + "'");
+		}
+
+		return value;
+	}
+
+	template<>
+	bool parseValue<bool>(const std::string& key, const std::string& text) {
+		if (text == "true" || text == "yes" || text == "on" || text == "1")
+			return true;
+		if (text == "false" || text == "no" || text == "off" || text == "0")
+			return false;
+
+		throw std::invalid_argument("invalid value '" + text + "' for parameter '" + key + "'");
+	}
+
+	template<>
+	std::string parseValue<std::string>(const std::string&, const std::string& text) {
+		return text;
+	}
+
+	/// Write a value so that reading it back gives the same value
+	template<typename T>
+	void writeValue(std::ostream& out, const T& value) {
+		out << value;
+	}
+
+	template<>
+	void writeValue<double>(std::ostream& out, const double& value) {
+		// shortest precision that reads back exactly
+		std::ostringstream text;
+		for (int precision = 6; precision <= std::numeric_limits<double>::max_digits10; ++precision) {
+			text.str("");
+			text.precision(precision);
+			text << value;
+
+			if (std::stod(text.str()) == value)
+				break;
+		}
+		out << text.str();
+	}
+
+	template<>
+	void writeValue<bool>(std::ostream& out, const bool& value) {
+		out << (value ? "true" : "false");
+	}
+
+	/// A named parameter of the configuration
+	struct Entry {
+		const char* key;											//!< name of the parameter
+		const char* help;											//!< description of the parameter
+		std::function<void(Config&, const std::string&)> set;		//!< parses and sets the value
+		std::function<void(const Config&, std::ostream&)> write;	//!< writes the value
+	};
+
+	template<typename T>
+	Entry makeEntry(const char* key, const char* help, T Config::* member) {
+		return {
+			key, help,
+			[=](Config& config, const std::string& value) { config.*member = parseValue<T>(key, value); },
+			[=](const Config& config, std::ostream& out) { writeValue(out, config.*member); }
+		};
+	}
+
+	/// All parameters, in the order they are written
+	const std::vector<Entry>& getEntries() {
+		static const std::vector<Entry> entries = {
+			makeEntry("eta", "external rate, relative to the threshold rate", &Config::eta),
+			makeEntry("g", "ratio of inhibitory vs excitatory transmission values", &Config::g),
+			makeEntry("j", "post-synaptic excitement after spike", &Config::j),
+			makeEntry("n_excitatory", "number of excitatory neurons", &Config::nExcitatory),
+			makeEntry("n_inhibitory", "number of inhibitory neurons", &Config::nInhibitory),
+			makeEntry("epsilon", "connectivity", &Config::epsilon),
+			makeEntry("tau", "membrane time constant, in s", &Config::tau),
+			makeEntry("resistance", "membrane resistance", &Config::resistance),
+			makeEntry("threshold", "firing threshold", &Config::threshold),
+			makeEntry("reset", "potential after a spike", &Config::reset),
+			makeEntry("refractory_time", "inactive steps after a spike", &Config::refractoryTime),
+			makeEntry("delay", "transmission delay, in steps", &Config::delay),
+			makeEntry("step_duration", "duration of one step, in s", &Config::stepDuration),
+			makeEntry("background_noise", "true if there is external noise", &Config::backgroundNoise),
+			makeEntry("current", "external current magnitude", &Config::current),
+			makeEntry("current_start", "first step of the external current", &Config::currentStart),
+			makeEntry("current_end", "last step of the external current", &Config::currentEnd),
+			makeEntry("duration", "length of the simulation, in steps", &Config::duration),
+			makeEntry("threads", "number of simulation threads", &Config::nThreads),
+			makeEntry("seed", "seed of all random streams", &Config::seed),
+			makeEntry("noise_producer", "generate the noise on a separate thread", &Config::noiseProducer),
+			makeEntry("output", "result file, derived from eta and g if empty", &Config::output),
+			makeEntry("format", "format of the result file, 'gdf' (text) or 'binary'", &Config::format),
+			makeEntry("stream_spikes", "write the spikes while simulating instead of keeping them", &Config::streamSpikes),
+			makeEntry("record_spikes", "write the spikes at all, the statistics are always computed", &Config::recordSpikes),
+			makeEntry("statistics", "file of the population statistics, none if empty", &Config::statistics),
+			makeEntry("statistics_bin", "width of a bin of the population rate, in steps", &Config::statisticsBin),
+			makeEntry("connection_cache", "binary file caching the connections, none if empty", &Config::connectionCache),
+			makeEntry("procedural_connections", "regenerate the connections on the fly instead of storing them", &Config::proceduralConnections),
+			makeEntry("verbose", "print the progress of the simulation", &Config::verbose),
+			makeEntry("checkpoint", "checkpoint file written during and after the run, none if empty", &Config::checkpoint),
+			makeEntry("checkpoint_interval", "steps between two checkpoints, 0 for the end of the run only", &Config::checkpointInterval),
+			makeEntry("restore", "checkpoint file the simulation resumes from, none if empty", &Config::restore),
+			makeEntry("ranks", "number of processes sharing the neurons", &Config::ranks),
+			makeEntry("rank", "index of this process among the ranks", &Config::rank),
+			makeEntry("socket", "Unix socket connecting the ranks", &Config::socket),
+			makeEntry("profile", "file of the time of every phase, none if empty, needs a PROFILING build", &Config::profile),
+			makeEntry("profile_timeline", "add the phases of every epoch to the profile", &Config::profileTimeline),
+			makeEntry("profile_counters", "add the hardware counters of every phase to the profile, if available", &Config::profileCounters),
+			makeEntry("trace", "Chrome trace of the threads, none if empty, needs a PROFILING build", &Config::trace),
+			makeEntry("sweep_eta", "values of eta of a sweep, 'first:last:step' or 'a,b,c'", &Config::sweepEta),
+			makeEntry("sweep_g", "values of g of a sweep, 'first:last:step' or 'a,b,c'", &Config::sweepG),
+			makeEntry("summary", "summary table of a sweep", &Config::summary),
+		};
+		return entries;
+	}
+
+	/// Remove leading and trailing whitespace
+	std::string trim(const std::string& text) {
+		const char* space = " \t\r\n";
+		std::size_t first = text.find_first_not_of(space);
+
+		if (first == std::string::npos)
+			return "";
+
+		return text.substr(first, text.find_last_not_of(space) - first + 1);
+	}
+}
+
+
+std::string Config::getOutput() const {
+	if (!output.empty())
+		return output;
+
+	std::ostringstream ss;
+	ss << "../results/spikes" <<
+		"_eta" << eta <<
+		"_g" << g <<
+		(format == "binary" ? ".spk" : ".gdf");
+	return ss.str();
+}
+
+namespace {
+	/// FNV-1a hash of the bytes of values
+	struct Hash {
+		uint64_t value = 0xCBF29CE484222325;
+
+		template<typename T>
+		Hash& add(const T& data) {
+			for (std::size_t i = 0; i < sizeof(T); ++i) {
+				value = (value ^ ((const unsigned char*) &data)[i]) * 0x100000001B3;
+			}
+			return *this;
+		}
+	};
+}
+
+uint64_t Config::getConnectionsHash() const {
+	// the parameters, with a version of the way connections are drawn
+	const uint32_t version = 1;
+	return Hash().add(version).add(nExcitatory).add(nInhibitory).add(epsilon).add(seed).value;
+}
+
+uint64_t Config::getModelHash() const {
+	// the connections, the dynamics and the way they are computed
+	const uint32_t version = 1;
+	Hash hash;
+	hash.add(version).add(getConnectionsHash()).add(proceduralConnections);
+	hash.add(eta).add(g).add(j).add(tau).add(resistance).add(threshold).add(reset);
+	hash.add(refractoryTime).add(delay).add(stepDuration).add(backgroundNoise);
+	hash.add(current).add(currentStart).add(currentEnd).add(statisticsBin);
+	return hash.value;
+}
+
+void Config::set(const std::string& key, const std::string& value) {
+	for (const Entry& entry : getEntries()) {
+		if (key == entry.key) {
+			entry.set(*this, trim(value));
+			return;
+		}
+	}
+
+	throw std::invalid_argument("unknown parameter '" + key + "'");
+}
+
+void Config::load(const std::string& filename) {
+	std::ifstream in(filename);
+
+	if (!in) {
+		throw std::invalid_argument("cannot open configuration file '" + filename + "'");
+	}
+
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(in, line)) {
+		++lineNumber;
+
+		// strip comments and blank lines
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty())
+			continue;
+
+		std::size_t equal = line.find('=');
+		if (equal == std::string::npos) {
+			throw std::invalid_argument(filename + ":" + std::to_string(lineNumber) + ": expected 'key = value'");
+		}
+
+		set(trim(line.substr(0, equal)), line.substr(equal + 1));
+	}
+}
+
+bool Config::parse(int argc, char** argv) {
+	// the values set by the program before parsing are the defaults
+	const Config defaults = *this;
+	
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+
+		if (arg == "--help" || arg == "-h") {
+			std::cout << "Usage: " << argv[0] << " [--config file] [--key=value ...]" << std::endl;
+			std::cout << std::endl << "Parameters (default value):" << std::endl;
+
+			for (const Entry& entry : getEntries()) {
+				std::cout << "  --" << entry.key << "\t" << entry.help << " (";
+				entry.write(defaults, std::cout);
+				std::cout << ")" << std::endl;
+			}
+			return false;
+		}
+
+		if (arg.compare(0, 2, "--") != 0) {
+			throw std::invalid_argument("unexpected argument '" + arg + "'");
+		}
+
+		// --key=value or --key value
+		std::string key, value;
+		std::size_t equal = arg.find('=');
+
+		if (equal != std::string::npos) {
+			key = arg.substr(2, equal - 2);
+			value = arg.substr(equal + 1);
+		} else if (i + 1 < argc) {
+			key = arg.substr(2);
+			value = argv[++i];
+		} else {
+			throw std::invalid_argument("missing value for '" + arg + "'");
+		}
+
+		if (key == "config") {
+			load(value);
+		} else {
+			set(key, value);
+		}
+	}
+
+	return true;
+}
+
+void Config::validate() const {
+	auto check = [](bool condition, const char* message) {
+		if (!condition)
+			throw std::invalid_argument(message);
+	};
+
+	check(nExcitatory >= 0 && nInhibitory >= 0 && getNbNeurons() > 0, "the network needs at least one neuron");
+	check(0.0 <= epsilon && epsilon <= 1.0, "epsilon must be between 0 and 1");
+	check(eta >= 0.0, "eta must not be negative");
+	check(j > 0.0, "j must be positive");
+	check(tau > 0.0 && stepDuration > 0.0, "tau and step_duration must be positive");
+	check(std::isfinite(getExternalSpikesPerStep()) && getExternalSpikesPerStep() >= 0.0,
+		  "the external rate must be finite and not negative, check the threshold");
+	check(refractoryTime >= 0, "refractory_time must not be negative");
+	check(delay >= 1, "delay must be at least one step");
+	check(currentStart <= currentEnd, "current_start must not be after current_end");
+	check(duration >= 0, "duration must not be negative");
+	check(nThreads >= 1, "threads must be at least 1");
+	check(format == "gdf" || format == "binary", "format must be 'gdf' or 'binary'");
+	check(statisticsBin >= 1, "statistics_bin must be at least one step");
+	check(checkpointInterval >= 0, "checkpoint_interval must not be negative");
+	check(ranks >= 1 && 0 <= rank && rank < ranks, "rank must be between 0 and ranks - 1");
+	check(ranks == 1 || !isSweep(), "a sweep runs in a single process");
+	check(checkpoint.empty() || !isSweep(), "a sweep does not write checkpoints");
+	check(restore.empty() || !isSweep(), "a sweep does not restore checkpoints");
+}
+
+void Config::write(std::ostream& out) const {
+	for (const Entry& entry : getEntries()) {
+		out << entry.key << " = ";
+		entry.write(*this, out);
+		out << '\n';
+	}
+}
@@ -0,0 +1,130 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include "Constants.hpp"
+
+/** \brief Parameters of one simulation run
+ *
+ * Defaults are the values of Constants.hpp. Every parameter can be changed
+ * at runtime, from a configuration file of "key = value" lines
+ * or from command-line flags "--key=value", so that reproducing another
+ * parameter point does not require recompiling.
+ * Invalid keys or values raise std::invalid_argument.
+ * */
+struct Config {
+
+	double eta = C::ETA;							//!< external rate, relative to the threshold rate
+	double g = C::G;								//!< ratio of inhibitory vs excitatory transmission values
+	double j = C::J_EXCITATORY;						//!< post-synaptic excitement after spike
+
+	int nExcitatory = C::N_EXCITATORY;				//!< number of excitatory neurons
+	int nInhibitory = C::N_INHIBITORY;				//!< number of inhibitory neurons
+	double epsilon = C::EPSILON;					//!< connectivity
+
+	double tau = C::TAU;							//!< membrane time constant, in s
+	double resistance = C::MEMBRANE_RESISTANCE;		//!< membrane resistance
+	double threshold = C::V_THRESHOLD;				//!< firing threshold
+	double reset = C::V_REST;						//!< potential after a spike
+	int refractoryTime = C::REFRACTORY_TIME;		//!< inactive steps after a spike
+	int delay = C::TRANSMISSION_DELAY;				//!< transmission delay, in steps
+	double stepDuration = C::STEP_DURATION;			//!< duration of one step, in s
+	bool backgroundNoise = C::IS_BACKGROUND_NOISE;	//!< true if there is external noise
+
+	double current = 0.0;							//!< external current magnitude
+	long currentStart = 0;							//!< first step of the external current
+	long currentEnd = 0;							//!< last step of the external current
+
+	long duration = 10000;							//!< length of the simulation, in steps
+	int nThreads = 1;								//!< number of simulation threads
+	uint64_t seed = C::SEED;						//!< seed of all random streams
+	bool noiseProducer = false;						//!< generate the noise on a separate thread
+
+	std::string output = "";						//!< result file, derived from eta and g if empty
+	std::string format = "gdf";						//!< format of the result file, "gdf" (text) or "binary"
+	bool streamSpikes = true;						//!< write the spikes while simulating instead of keeping them
+	bool recordSpikes = true;						//!< write the spikes at all, the statistics are always computed
+	std::string statistics = "";					//!< file of the population statistics, none if empty
+	long statisticsBin = 10;						//!< width of a bin of the population rate, in steps
+	std::string connectionCache = "";				//!< binary file caching the connections, none if empty
+	bool proceduralConnections = false;				//!< regenerate the connections on the fly instead of storing them
+	bool verbose = true;							//!< print the progress of the simulation
+
+	std::string checkpoint = "";					//!< checkpoint file written during and after the run, none if empty
+	long checkpointInterval = 0;					//!< steps between two checkpoints, 0 for the end of the run only
+	std::string restore = "";						//!< checkpoint file the simulation resumes from, none if empty
+
+	int ranks = 1;									//!< number of processes sharing the neurons
+	int rank = 0;									//!< index of this process among the ranks
+	std::string socket = "/tmp/brunel.sock";		//!< Unix socket connecting the ranks
+
+	std::string profile = "";						//!< file of the time of every phase, none if empty, needs a PROFILING build
+	bool profileTimeline = false;					//!< add the phases of every epoch to the profile
+	bool profileCounters = false;					//!< add the hardware counters of every phase to the profile, if available
+	std::string trace = "";							//!< Chrome trace of the threads, none if empty, needs a PROFILING build
+
+	std::string sweepEta = "";						//!< values of eta of a sweep, see Sweep::parseGrid()
+	std::string sweepG = "";						//!< values of g of a sweep, see Sweep::parseGrid()
+	std::string summary = "../results/sweep.txt";	//!< summary table of a sweep
+
+
+	/// Get the total number of neurons
+	int getNbNeurons() const { return nExcitatory + nInhibitory; }
+
+	/// Get the number of incoming excitatory connections of any neuron
+	int getNbExcitatoryConnections() const { return (int) (epsilon * nExcitatory); }
+
+	/// Get the number of incoming inhibitory connections of any neuron
+	int getNbInhibitoryConnections() const { return (int) (epsilon * nInhibitory); }
+
+	/// Get the number of incoming connections of any neuron
+	int getNbConnections() const { return getNbExcitatoryConnections() + getNbInhibitoryConnections(); }
+
+	/// Get the post-synaptic inhibition after spike
+	double getJInhibitory() const { return -g * j; }
+
+	/// Get the mean number of external spikes received by a neuron during one step
+	double getExternalSpikesPerStep() const { return eta * threshold / (j * tau) * stepDuration; }
+
+	/// Get the result file name
+	std::string getOutput() const;
+
+	/// Get a hash of all parameters the connections depend on
+	uint64_t getConnectionsHash() const;
+
+	/// Get a hash of all parameters the state of a simulation depends on, but its duration
+	uint64_t getModelHash() const;
+
+	/// Get whether the parameters describe a sweep over several values of eta and g
+	bool isSweep() const { return !sweepEta.empty() || !sweepG.empty(); }
+
+
+	/*! \brief Set one parameter
+	 *
+	 * \param key		name of the parameter, as written by write()
+	 * \param value		new value, as text
+	 */
+	void set(const std::string& key, const std::string& value);
+
+	/// Read "key = value" lines from a file, '#' starts a comment
+	void load(const std::string& filename);
+
+	/*! \brief Read command-line flags
+	 *
+	 * Accepts "--key=value" and "--key value"; "--config file" loads a file,
+	 * later flags override earlier ones.
+	 *
+	 * \return false if the help was requested
+	 */
+	bool parse(int argc, char** argv);
+
+	/// Make sure the parameters describe a valid simulation
+	void validate() const;
+
+	/// Write all parameters as "key = value" lines
+	void write(std::ostream& out) const;
+};
+
+#endif
@@ -11,6 +11,9 @@ namespace C {
 	/// Flag for tests: true if there is external noise, false otherwise
 	constexpr bool IS_BACKGROUND_NOISE = true;
 	
+	/// Default seed of all random streams
+	constexpr unsigned long SEED = 20171207;
+	
 	/// Duration in s of one simulation step (0.1ms)
 	constexpr auto STEP_DURATION = 0.1E-3;
 	
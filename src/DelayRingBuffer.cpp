@@ -0,0 +1,31 @@
+#include <cassert>
+#include "DelayRingBuffer.hpp"
+#include "Checkpoint.hpp"
+
+namespace {
+	/// Number of doubles in a cache line
+	constexpr long LINE = 64 / sizeof(double);
+}
+
+DelayRingBuffer::DelayRingBuffer(int size, int n)
+	: nSlots(n),
+	  stride((size + LINE - 1) / LINE * LINE),
+	  data(nSlots * stride, 0.0)
+{
+	assert(nSlots > 0);
+}
+
+// get the number of time slots
+int DelayRingBuffer::getNbSlots() const {
+	return nSlots;
+}
+
+// write all rows to a checkpoint
+void DelayRingBuffer::save(std::ostream& out) const {
+	Checkpoint::writeArray(out, data);
+}
+
+// read all rows from a checkpoint
+void DelayRingBuffer::load(std::istream& in) {
+	Checkpoint::readArray(in, data, data.size());
+}
@@ -0,0 +1,56 @@
+#ifndef DELAY_RING_BUFFER_H
+#define DELAY_RING_BUFFER_H
+
+#include <istream>
+#include <ostream>
+#include "AlignedAllocator.hpp"
+
+/** \brief Network-wide circular buffer of incoming potentials
+ *
+ * One contiguous row per time slot, holding the potential every neuron
+ * will receive at that time. Rows are padded to a whole number of cache lines,
+ * so that every row starts aligned.
+ * */
+class DelayRingBuffer {
+
+public:
+	/*! \brief DelayRingBuffer constructor
+	 *
+	 * \param size		number of neurons
+	 * \param nSlots	number of time slots, must be larger than the transmission delay
+	 */
+	DelayRingBuffer(int size, int nSlots);
+
+	/// Get the number of time slots
+	int getNbSlots() const;
+
+	/// Get the row of the potentials arriving at \p time
+	double* getRow(long time) {
+		return data.data() + (time % nSlots) * stride;
+	}
+
+	/// Get the row of the potentials arriving at \p time
+	const double* getRow(long time) const {
+		return data.data() + (time % nSlots) * stride;
+	}
+
+	/// Add \p pot to the potential arriving at neuron \p idx at time \p arrival
+	void add(int idx, double pot, long arrival) {
+		getRow(arrival)[idx] += pot;
+	}
+
+	/// Write all rows to a checkpoint
+	void save(std::ostream& out) const;
+
+	/// Read all rows from a checkpoint of a buffer of the same size
+	void load(std::istream& in);
+
+private:
+
+	int nSlots;						//!< number of time slots
+	long stride;					//!< distance between two rows, in elements
+
+	AlignedVector<double> data;		//!< all rows, zero-initialised
+};
+
+#endif
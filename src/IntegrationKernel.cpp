@@ -0,0 +1,247 @@
+#include <cassert>
+#include "IntegrationKernel.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace Kernel {
+
+namespace {
+
+// update a single neuron, reference for the vectorized versions
+inline int integrateOne(const Parameters& params, int i,
+						double* potentials, int* refractory, double* input, int* spikes) {
+	double potential = potentials[i];
+	int remaining = refractory[i];
+	int nSpikes = 0;
+
+	// if the potential is over the threshold, emit a spike
+	if (potential >= params.threshold) {
+		spikes[nSpikes++] = i;
+		potential = params.reset;
+		remaining = params.refractoryTime;
+	}
+
+	if (remaining > 0) {
+		--remaining;
+	} else {
+		potential = params.c1 * potential + params.drive + input[i];
+	}
+
+	potentials[i] = potential;
+	refractory[i] = remaining;
+	input[i] = 0.0;
+
+	return nSpikes;
+}
+
+int integrateScalar(const Parameters& params, int first, int last,
+					double* potentials, int* refractory, double* input, int* spikes) {
+	int nSpikes = 0;
+
+	for (int i = first; i < last; ++i) {
+		nSpikes += integrateOne(params, i, potentials, refractory, input, spikes + nSpikes);
+	}
+
+	return nSpikes;
+}
+
+#ifdef KERNEL_X86
+
+// append the indices of the set bits of mask, offset by i
+inline int compact(unsigned mask, int i, int* spikes) {
+	int nSpikes = 0;
+
+	while (mask != 0) {
+		spikes[nSpikes++] = i + __builtin_ctz(mask);
+		mask &= mask - 1;
+	}
+
+	return nSpikes;
+}
+
+__attribute__((target("sse2")))
+int integrateSSE2(const Parameters& params, int first, int last,
+				  double* potentials, int* refractory, double* input, int* spikes) {
+	const __m128d c1 = _mm_set1_pd(params.c1);
+	const __m128d drive = _mm_set1_pd(params.drive);
+	const __m128d threshold = _mm_set1_pd(params.threshold);
+	const __m128d reset = _mm_set1_pd(params.reset);
+	const __m128i refractoryTime = _mm_set1_epi32(params.refractoryTime);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+
+	int nSpikes = 0;
+	int i = first;
+
+	for (; i + 2 <= last; i += 2) {
+		__m128d p = _mm_loadu_pd(potentials + i);
+		__m128i r = _mm_loadl_epi64((const __m128i*) (refractory + i));
+
+		// fire: reset the potential and start the refractory period
+		__m128d spike = _mm_cmpge_pd(p, threshold);
+		__m128i spike32 = _mm_shuffle_epi32(_mm_castpd_si128(spike), _MM_SHUFFLE(2, 0, 2, 0));
+		p = _mm_or_pd(_mm_and_pd(spike, reset), _mm_andnot_pd(spike, p));
+		r = _mm_or_si128(_mm_and_si128(spike32, refractoryTime), _mm_andnot_si128(spike32, r));
+
+		// integrate the active neurons, count down the others
+		__m128i active32 = _mm_cmpeq_epi32(r, zero);
+		__m128d active = _mm_castsi128_pd(_mm_unpacklo_epi32(active32, active32));
+		__m128d integrated = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c1, p), drive), _mm_loadu_pd(input + i));
+		p = _mm_or_pd(_mm_and_pd(active, integrated), _mm_andnot_pd(active, p));
+		r = _mm_sub_epi32(_mm_sub_epi32(r, one), active32);
+
+		_mm_storeu_pd(potentials + i, p);
+		_mm_storel_epi64((__m128i*) (refractory + i), r);
+		_mm_storeu_pd(input + i, _mm_setzero_pd());
+
+		nSpikes += compact(_mm_movemask_pd(spike), i, spikes + nSpikes);
+	}
+
+	return nSpikes + integrateScalar(params, i, last, potentials, refractory, input, spikes + nSpikes);
+}
+
+__attribute__((target("avx2")))
+int integrateAVX2(const Parameters& params, int first, int last,
+				  double* potentials, int* refractory, double* input, int* spikes) {
+	const __m256d c1 = _mm256_set1_pd(params.c1);
+	const __m256d drive = _mm256_set1_pd(params.drive);
+	const __m256d threshold = _mm256_set1_pd(params.threshold);
+	const __m256d reset = _mm256_set1_pd(params.reset);
+	const __m128i refractoryTime = _mm_set1_epi32(params.refractoryTime);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+
+	int nSpikes = 0;
+	int i = first;
+
+	for (; i + 4 <= last; i += 4) {
+		__m256d p = _mm256_loadu_pd(potentials + i);
+		__m128i r = _mm_loadu_si128((const __m128i*) (refractory + i));
+
+		// fire: reset the potential and start the refractory period
+		__m256d spike = _mm256_cmp_pd(p, threshold, _CMP_GE_OQ);
+		__m128 spikeHalves = _mm_shuffle_ps(_mm256_castps256_ps128(_mm256_castpd_ps(spike)),
+											_mm256_extractf128_ps(_mm256_castpd_ps(spike), 1),
+											_MM_SHUFFLE(2, 0, 2, 0));
+		__m128i spike32 = _mm_castps_si128(spikeHalves);
+		p = _mm256_blendv_pd(p, reset, spike);
+		r = _mm_blendv_epi8(r, refractoryTime, spike32);
+
+		// integrate the active neurons, count down the others
+		__m128i active32 = _mm_cmpeq_epi32(r, zero);
+		__m256d active = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(active32));
+		__m256d integrated = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c1, p), drive), _mm256_loadu_pd(input + i));
+		p = _mm256_blendv_pd(p, integrated, active);
+		r = _mm_sub_epi32(_mm_sub_epi32(r, one), active32);
+
+		_mm256_storeu_pd(potentials + i, p);
+		_mm_storeu_si128((__m128i*) (refractory + i), r);
+		_mm256_storeu_pd(input + i, _mm256_setzero_pd());
+
+		nSpikes += compact(_mm256_movemask_pd(spike), i, spikes + nSpikes);
+	}
+
+	return nSpikes + integrateScalar(params, i, last, potentials, refractory, input, spikes + nSpikes);
+}
+
+__attribute__((target("avx512f")))
+int integrateAVX512(const Parameters& params, int first, int last,
+					double* potentials, int* refractory, double* input, int* spikes) {
+	const __m512d c1 = _mm512_set1_pd(params.c1);
+	const __m512d drive = _mm512_set1_pd(params.drive);
+	const __m512d threshold = _mm512_set1_pd(params.threshold);
+	const __m512d reset = _mm512_set1_pd(params.reset);
+	const __m512i refractoryTime = _mm512_set1_epi64(params.refractoryTime);
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i one = _mm512_set1_epi64(1);
+	const __mmask8 all = 0xFF;
+
+	int nSpikes = 0;
+	int i = first;
+
+	for (; i + 8 <= last; i += 8) {
+		__m512d p = _mm512_loadu_pd(potentials + i);
+		__m512i r = _mm512_maskz_cvtepi32_epi64(all, _mm256_loadu_si256((const __m256i*) (refractory + i)));
+
+		// fire: reset the potential and start the refractory period
+		__mmask8 spike = _mm512_cmp_pd_mask(p, threshold, _CMP_GE_OQ);
+		p = _mm512_mask_blend_pd(spike, p, reset);
+		r = _mm512_mask_blend_epi64(spike, r, refractoryTime);
+
+		// integrate the active neurons, count down the others
+		__mmask8 active = _mm512_cmpeq_epi64_mask(r, zero);
+		__m512d integrated = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(c1, p), drive), _mm512_loadu_pd(input + i));
+		p = _mm512_mask_blend_pd(active, p, integrated);
+		r = _mm512_mask_sub_epi64(r, (__mmask8) ~active, r, one);
+
+		_mm512_storeu_pd(potentials + i, p);
+		_mm256_storeu_si256((__m256i*) (refractory + i), _mm512_maskz_cvtepi64_epi32(all, r));
+		_mm512_storeu_pd(input + i, _mm512_setzero_pd());
+
+		nSpikes += compact(spike, i, spikes + nSpikes);
+	}
+
+	return nSpikes + integrateScalar(params, i, last, potentials, refractory, input, spikes + nSpikes);
+}
+
+#endif
+
+SimdLevel detectLevel() {
+#ifdef KERNEL_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f"))
+		return SimdLevel::AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return SimdLevel::AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return SimdLevel::SSE2;
+#endif
+	return SimdLevel::Scalar;
+}
+
+}
+
+
+SimdLevel getSupportedLevel() {
+	static const SimdLevel level = detectLevel();
+	return level;
+}
+
+const char* getName(SimdLevel level) {
+	switch (level) {
+		case SimdLevel::SSE2:	return "SSE2";
+		case SimdLevel::AVX2:	return "AVX2";
+		case SimdLevel::AVX512:	return "AVX-512";
+		default:				return "scalar";
+	}
+}
+
+int integrate(SimdLevel level, const Parameters& params, int first, int last,
+			  double* potentials, int* refractory, double* input, int* spikes) {
+	// make sure the CPU can run the requested kernel
+	assert(level <= getSupportedLevel());
+
+	switch (level) {
+#ifdef KERNEL_X86
+		case SimdLevel::AVX512:
+			return integrateAVX512(params, first, last, potentials, refractory, input, spikes);
+		case SimdLevel::AVX2:
+			return integrateAVX2(params, first, last, potentials, refractory, input, spikes);
+		case SimdLevel::SSE2:
+			return integrateSSE2(params, first, last, potentials, refractory, input, spikes);
+#endif
+		default:
+			return integrateScalar(params, first, last, potentials, refractory, input, spikes);
+	}
+}
+
+int integrate(const Parameters& params, int first, int last,
+			  double* potentials, int* refractory, double* input, int* spikes) {
+	return integrate(getSupportedLevel(), params, first, last, potentials, refractory, input, spikes);
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef INTEGRATION_KERNEL_H
+#define INTEGRATION_KERNEL_H
+
+/*! \file IntegrationKernel.hpp
+    \brief Vectorized leaky integrate-and-fire update of a block of neurons.
+*/
+
+namespace Kernel {
+
+	/// Instruction sets the integration kernel is available for
+	enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+	/// Parameters of one integration step, shared by all neurons
+	struct Parameters {
+		double c1;				//!< membrane decay factor
+		double drive;			//!< contribution of the external current, c2 * I
+		double threshold;		//!< firing threshold
+		double reset;			//!< potential after a spike
+		int refractoryTime;		//!< inactive steps after a spike, the spiking step included
+	};
+
+	/*! \brief Get the best instruction set supported by the running CPU
+	 *
+	 *  Detected once, at the first call
+	 */
+	SimdLevel getSupportedLevel();
+
+	/// Get a printable name for \p level
+	const char* getName(SimdLevel level);
+
+	/*! \brief Advance the neurons in [\p first, \p last) by one step
+	 *
+	 *  For every neuron: fires if the potential is over the threshold,
+	 *  then either counts down its refractory period or integrates
+	 *  the membrane equation with the given input. The input is cleared.
+	 *  All arrays are indexed from the start of the population.
+	 *
+	 *  \param level		instruction set to use, must be supported by the CPU
+	 *  \param params		integration parameters
+	 *  \param first		index of the first neuron to update
+	 *  \param last			index after the last neuron to update
+	 *  \param potentials	membrane potentials
+	 *  \param refractory	remaining refractory steps, 0 if active
+	 *  \param input		potential received by each neuron during this step, reset to 0
+	 *  \param spikes		output, receives the indices of the spiking neurons in increasing order
+	 *
+	 *  \return The number of indices written to \p spikes
+	 */
+	int integrate(SimdLevel level, const Parameters& params, int first, int last,
+				  double* potentials, int* refractory, double* input, int* spikes);
+
+	/// Same as above, with the best supported instruction set
+	int integrate(const Parameters& params, int first, int last,
+				  double* potentials, int* refractory, double* input, int* spikes);
+}
+
+#endif
@@ -3,120 +3,835 @@
 #include <ctime>
 #include <sstream> 
 #include <string>
+#include <queue>
+#include <functional>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <tuple>
+#include <chrono>
+#include <stdexcept>
+#include <exception>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "Network.hpp"
+#include "Checkpoint.hpp"
 
-Network::Network(Current* c, long duration)
-	: current(c),
-	  t(0), tEnd(std::abs(duration))
-{
-	std::cout << "Generating network..." << std::flush;
-	time_t t1 = time(0);
+namespace {
+	/// Get \p config, once its parameters were checked
+	const Config& validated(const Config& config) {
+		config.validate();
+		return config;
+	}
 	
-	// make sure there is a current
+	/// Split neurons [first, last) in ranges of whole cache lines, return range \p part of \p nParts
+	std::pair<int, int> split(int first, int last, int part, int nParts) {
+		const int line = 64 / sizeof(double);
+		const int perPart = ((last - first) / line + nParts - 1) / nParts * line;
+		
+		return std::make_pair(std::min(first + part * perPart, last),
+							  part + 1 < nParts ? std::min(first + (part + 1) * perPart, last) : last);
+	}
+}
+
+Network::Network(Current* c, const Config& conf)
+	: Network(c, conf, connect(conf), nullptr)
+{}
+
+Network::Network(Current* c, const Config& conf, Transport& transport)
+	: Network(c, conf, connect(conf, getRange(conf.getNbNeurons(), transport.getRank(), transport.size()).first,
+							   getRange(conf.getNbNeurons(), transport.getRank(), transport.size()).second),
+			  &transport)
+{}
+
+Network::Network(Current* c, const Config& conf, std::shared_ptr<const SynapseMatrix> s, Transport* tr)
+	: Network(c, conf, share(s), tr)
+{}
+
+Network::Network(Current* c, const Config& conf, const Connections& connections, Transport* tr)
+	: config(validated(conf)),
+	  tracer(Profiler::ENABLED && !conf.trace.empty() ? new Tracer(tr != nullptr ? tr->getRank() : 0, connections.start) : nullptr),
+	  profiler(Profiler::ENABLED && (!conf.profile.empty() || tracer != nullptr) ?
+			   new Profiler(conf.nThreads, conf.profileTimeline, conf.profileCounters, tracer.get()) : nullptr),
+	  current(c),
+	  t(0), tEnd(std::abs(config.duration)),
+	  first(getRange(config.getNbNeurons(), tr != nullptr ? tr->getRank() : 0, tr != nullptr ? tr->size() : 1).first),
+	  last(getRange(config.getNbNeurons(), tr != nullptr ? tr->getRank() : 0, tr != nullptr ? tr->size() : 1).second),
+	  population(config, first, last),
+	  synapses(connections.synapses),
+	  procedural(config.proceduralConnections ? new ProceduralConnections(config.getNbNeurons(), config.epsilon, config.seed) : nullptr),
+	  noise(new NoisePipeline(population.getNoise(), first, last, config.delay)),
+	  pool(new ThreadPool(config.nThreads)),
+	  appendOutput(false),
+	  transport(tr != nullptr && tr->size() > 1 ? tr : nullptr),
+	  partitions(pool->size())
+{
+	// make sure there is a current and the connections match
 	assert(current != nullptr);
+	assert(procedural != nullptr || (synapses != nullptr && synapses->size() == config.getNbNeurons()));
 	
-	// init neuron array
-	neurons = { nullptr };
-
-	// generate neurons
-	for (int i = 0; i < (int) C::N_TOTAL; ++i) {
-		// neurons from index 0 to C::N_EXCITATORY are exictatory,
-		// the rest are inhibitory
-		bool isExcitatory = i < C::N_EXCITATORY;
-		neurons[i] = new Neuron(isExcitatory);		
+	// the neurons of this rank, split in ranges of whole cache lines, one per thread
+	for (int i = 0; i < (int) partitions.size(); ++i) {
+		Partition& part = partitions[i];
+		std::tie(part.first, part.last) = split(first, last, i, partitions.size());
+		part.stepEnds.resize(config.delay, 0);
+	}
+	
+	if (config.backgroundNoise && config.noiseProducer) {
+		noise->startProducer();
+	}
+	
+	// streamed spikes are not kept, and neither are spikes not recorded at all
+	population.setSpikeHistory(config.recordSpikes && !config.streamSpikes);
+	
+	// the first rank writes the intervals of all neurons, the others keep those of their own
+	statistics.reset(new PopulationStatistics(config.nExcitatory, config.nInhibitory, pool->size(),
+											  config.statisticsBin, config.stepDuration, tEnd,
+											  isRoot() ? 0 : first, isRoot() ? config.getNbNeurons() : last));
+	
+	// the tracks of the simulation threads, then the one of the spike writer
+	if (tracer != nullptr) {
+		tracer->addTrack("spike writer");
 	}
 	
-	// generate random connections
+	if (profiler != nullptr) {
+		profiler->add(Profiler::CONNECTIONS, connections.start, connections.end);
+		profiler->add(Profiler::SETUP, connections.end, Profiler::Clock::now());
+	} else if ((!config.profile.empty() || !config.trace.empty()) && isRoot()) {
+		std::cerr << "Warning: the profile and the trace need a build with the PROFILING option, they are not written" << std::endl;
+	}
+}
+
+// get the neurons of one rank
+std::pair<int, int> Network::getRange(int nNeurons, int rank, int nRanks) {
+	return split(0, nNeurons, rank, nRanks);
+}
 
-	std::array<int, (std::size_t) (C::C_EXCITATORY)> excitatoryTable = { 0 };
-	std::array<int, (std::size_t) (C::C_INHIBITORY)> inhibitoryTable = { 0 };
+// draw or map the connections of a network, and time it
+Network::Connections Network::connect(const Config& config, int firstTarget, int lastTarget) {
+	Connections connections;
+	connections.start = Profiler::Clock::now();
+	if (!config.proceduralConnections) {
+		connections.synapses = createSynapses(config, firstTarget, lastTarget);
+	}
+	connections.end = Profiler::Clock::now();
+	return connections;
+}
+
+// get connections given to the constructor
+Network::Connections Network::share(std::shared_ptr<const SynapseMatrix> synapses) {
+	Connections connections;
+	connections.synapses = synapses;
+	connections.start = connections.end = Profiler::Clock::now();
+	return connections;
+}
+
+// draw the random connections of a network
+std::shared_ptr<const SynapseMatrix> Network::createSynapses(const Config& config, int firstTarget, int lastTarget) {
+	config.validate();
+	
+	const int nNeurons = config.getNbNeurons();
+	if (lastTarget < 0) {
+		lastTarget = nNeurons;
+	}
+	assert(0 <= firstTarget && firstTarget <= lastTarget && lastTarget <= nNeurons);
 	
-	for (int i = 0; i < (int) C::N_TOTAL; ++i) {
-		// create and assign excitatory connections
-		createConnections(excitatoryTable, i, 0, C::N_EXCITATORY - 1);
+	// the connections to a range of targets have a cache of their own
+	uint64_t hash = config.getConnectionsHash();
+	std::string cache = config.connectionCache;
+	if (!cache.empty() && (firstTarget != 0 || lastTarget != nNeurons)) {
+		cache += "." + std::to_string(firstTarget) + "-" + std::to_string(lastTarget);
+		hash = (hash ^ ((uint64_t) firstTarget << 32 | (uint32_t) lastTarget)) * 0x100000001B3;
+	}
+	
+	// reuse the cached connections if they were built from the same parameters
+	if (!cache.empty()) {
+		auto cached = SynapseMatrix::load(cache, hash);
 		
-		// create and assign inhibitory connections
-		createConnections(inhibitoryTable, i, C::N_EXCITATORY, C::N_TOTAL - 1);
+		if (cached != nullptr) {
+			if (config.verbose) {
+				std::cout << "Loading network..." << '\t' << "[mapped from '" << cache << "']" << std::endl;
+			}
+			return cached;
+		}
 	}
 	
+	if (config.verbose) {
+		std::cout << "Generating network..." << std::flush;
+	}
+	const auto t1 = std::chrono::steady_clock::now();
+	
+	const int nExcitatory = config.getNbExcitatoryConnections();
+	const int nInhibitory = config.getNbInhibitoryConnections();
+	
+	ThreadPool pool(config.nThreads);
+	Philox generator(config.seed);
+	
+	// generate random connections: the sources of every target, excitatory ones first
+	const int nTargets = lastTarget - firstTarget;
+	std::vector<int> sources((std::size_t) nTargets * config.getNbConnections());
+	
+	pool.run([&](int thread) {
+		const int first = firstTarget + (long) nTargets * thread / pool.size();
+		const int last = firstTarget + (long) nTargets * (thread + 1) / pool.size();
+		
+		for (int i = first; i < last; ++i) {
+			int* table = &sources[(std::size_t) (i - firstTarget) * config.getNbConnections()];
+			
+			// create excitatory connections
+			createConnections(generator, i, Stream::EXCITATORY, table, nExcitatory, 0, config.nExcitatory - 1);
+			
+			// create inhibitory connections
+			createConnections(generator, i, Stream::INHIBITORY, table + nExcitatory, nInhibitory, config.nExcitatory, nNeurons - 1);
+		}
+	});
+	
+	// assign the connections to their sources
+	auto synapses = std::make_shared<const SynapseMatrix>(nNeurons, config.getNbConnections(), sources, pool, firstTarget);
 	
-	time_t t2 = time(0);
-	std::cout << '\t' << "[done in " << t2 - t1 << "s]" << std::endl;
+	const auto t2 = std::chrono::steady_clock::now();
+	if (config.verbose) {
+		std::cout << '\t' << "[done in " << std::chrono::duration<double>(t2 - t1).count() << " s]" << std::endl;
+	}
+	
+	if (!cache.empty() && !synapses->save(cache, hash, config.seed)) {
+		std::cerr << "Warning: cannot write the connection cache '" << cache << "'" << std::endl;
+	}
+	
+	return synapses;
 }
 
 
-Network::~Network() {
-	// safely delete all dynamically allocated neurons
-	for (auto& neuron : neurons) {
-		delete neuron;
-		neuron = nullptr;
+const Config& Network::getConfig() const {
+	return config;
+}
+
+const NeuronPopulation& Network::getPopulation() const {
+	return population;
+}
+
+const SynapseMatrix& Network::getSynapses() const {
+	assert(synapses != nullptr);
+	return *synapses;
+}
+
+const PopulationStatistics& Network::getStatistics() const {
+	return *statistics;
+}
+
+// get the number of synaptic events so far
+long Network::getNbSynapticEvents() const {
+	long events = 0;
+	
+	for (int i = 0; i < config.getNbNeurons(); ++i) {
+		const long nSpikes = population.getNbSpikes(i);
+		if (nSpikes == 0)
+			continue;
+		
+		events += nSpikes * getNbTargets(i);
 	}
+	return events;
 }
 
 void Network::run() {
-	std::cout << "Running..." << std::flush;
+	if (config.verbose) {
+		std::cout << "Running..." << std::flush;
+	}
 
 	// get beginning of the simulation
-	time_t t1 = time(0);
+	typedef Profiler::Clock Clock;
+	const Clock::time_point t1 = Clock::now();
 	
-	// make sure the neurons were initialised
-	// logic: pick the first one, assume that if it has been initialised, so has the rest
-	assert(neurons[0] != nullptr);
+	const long interval = config.checkpoint.empty() ? 0 : config.checkpointInterval;
 	
-	// main simulation loop
-	while (t < tEnd) {	
-			
-		// update the network
-		for (auto neuron : neurons) {
+	while (true) {
+		// write the spikes while simulating, at least one thread's range fits in a chunk;
+		// the first rank writes the spikes of the other ranks in a lane of its own
+		if (config.recordSpikes && config.streamSpikes && isRoot() && recorder == nullptr) {
+			int chunkSize = 4096;
+			for (const Partition& part : partitions) {
+				chunkSize = std::max(chunkSize, part.last - part.first);
+			}
+			if (transport != nullptr) {
+				chunkSize = std::max(chunkSize, config.getNbNeurons() - last);
+			}
 			
-			// update the neuron, 1 step, no external current
-			bool spiked = neuron->update(1, current->getValue(t));
+			std::unique_ptr<SpikeWriter> output = SpikeWriter::open(config.getOutput(), config.format, config.getNbNeurons(), 1, appendOutput);
+			if (tracer != nullptr) {
+				output.reset(new TracedSpikeWriter(std::move(output), *tracer, pool->size()));
+			}
 			
-			if (spiked) {				
-				// transmit spike to targets with delay
-				for (auto target : neuron->getConnectionTargets()) {
-					neurons[target]->receive(neuron->getTransmissionValue(), t + C::TRANSMISSION_DELAY);
-				}
+			recorder.reset(new SpikeRecorder(std::move(output), pool->size() + (transport != nullptr ? 1 : 0), chunkSize));
+			if (!recorder->isOpen()) {
+				std::cerr << "Warning: cannot write the result file '" << config.getOutput() << "'" << std::endl;
 			}
 		}
 		
+		// simulate until the next checkpoint, or the end
+		const long end = interval > 0 ? std::min((t / interval + 1) * interval, tEnd) : tEnd;
+		
+		// the default delay gets a loop specialised at compile time
+		const Clock::time_point start = Clock::now();
+		if (config.delay == C::TRANSMISSION_DELAY) {
+			simulate<C::TRANSMISSION_DELAY>(end);
+		} else {
+			simulate<0>(end);
+		}
+		if (profiler != nullptr) {
+			profiler->add(Profiler::SIMULATION, start, Clock::now());
+		}
+		
 		// increment time
-		++t;
+		population.tick(end - t);
+		t = end;
+		
+		if (t >= tEnd)
+			break;
+		
+		const Clock::time_point written = Clock::now();
+		if (!checkpoint(config.checkpoint)) {
+			std::cerr << "Warning: cannot write the checkpoint '" << config.checkpoint << "'" << std::endl;
+		}
+		if (profiler != nullptr) {
+			profiler->add(Profiler::CHECKPOINT, written, Clock::now());
+		}
+	}
+	
+	// write the last spikes, a later run continues the file
+	const Clock::time_point finished = Clock::now();
+	if (recorder != nullptr) {
+		recorder->finish();
+		recorder.reset();
+		appendOutput = true;
+	}
+	statistics->finish(tEnd);
+	if (profiler != nullptr) {
+		profiler->add(Profiler::OUTPUT, finished, Clock::now());
+	}
+	
+	// the final state, to extend the simulation later
+	const Clock::time_point written = Clock::now();
+	if (!config.checkpoint.empty() && !checkpoint(config.checkpoint)) {
+		std::cerr << "Warning: cannot write the checkpoint '" << config.checkpoint << "'" << std::endl;
+	}
+	if (profiler != nullptr && !config.checkpoint.empty()) {
+		profiler->add(Profiler::CHECKPOINT, written, Clock::now());
 	}
 
 	// get end of the simulation
-	time_t t2 = time(0);
+	const Clock::time_point t2 = Clock::now();
+
+	if (config.verbose) {
+		std::cout << '\t' << '\t' << "[done in " << std::chrono::duration<double>(t2 - t1).count() << " s, " << tEnd << " steps]" << std::endl;
+	}
+	
+	// every rank profiles its own threads
+	if (profiler != nullptr && !config.profile.empty()) {
+		if (config.profileCounters && !profiler->getCountersError().empty() && isRoot()) {
+			std::cerr << "Warning: some hardware counters are unavailable, " << profiler->getCountersError() << std::endl;
+		}
+		
+		const std::string filename = getRankFile(config.profile);
+		std::ofstream out(filename);
+		profiler->write(out);
+		
+		if (!out.flush()) {
+			std::cerr << "Warning: cannot write the profile '" << filename << "'" << std::endl;
+		}
+	}
+	
+	if (tracer != nullptr) {
+		const std::string filename = getRankFile(config.trace);
+		std::ofstream out(filename);
+		tracer->write(out);
+		
+		if (!out.flush()) {
+			std::cerr << "Warning: cannot write the trace '" << filename << "'" << std::endl;
+		}
+	}
+}
+
+
+template<int DELAY>
+void Network::simulate(long end) {
+	const long delay = DELAY > 0 ? DELAY : config.delay;
+	
+	// epochs start on multiples of the delay
+	auto getEpochEnd = [&](long epoch) {
+		return std::min((epoch / delay + 1) * delay, end);
+	};
+	
+	const int rank = transport != nullptr ? transport->getRank() : 0;
+	const int nRanks = transport != nullptr ? transport->size() : 1;
+	
+	// the profiler is compiled out without the PROFILING option
+	Profiler* const profile = Profiler::ENABLED ? profiler.get() : nullptr;
+	
+	// an error of the exchange, on the first thread, stops all threads at the next barrier
+	std::exception_ptr failure;
+	
+	// the producer thread works one epoch ahead of the simulation
+	const bool hasNoise = config.backgroundNoise;
+	const bool isProducer = hasNoise && noise->hasProducer();
+	if (isProducer && t < end) {
+		noise->request(t, getEpochEnd(t) - t);
+		noise->wait(t);
+		
+		const long next = getEpochEnd(t);
+		if (next < end) {
+			noise->request(next, getEpochEnd(next) - next);
+		}
+	}
+	
+	// main simulation loop, on every thread
+	pool->run([&](int thread) {
+		Partition& part = partitions[thread];
+		const int range = part.last - part.first;
+		
+		if (profile != nullptr) {
+			profile->start(thread);
+		}
+		
+		// neurons are causally independent for the duration of the delay:
+		// every thread advances its neurons through a whole epoch before exchanging spikes
+		for (long epoch = t; epoch < end; epoch = getEpochEnd(epoch)) {
+			const long epochEnd = getEpochEnd(epoch);
+			
+			// generate the background noise of the whole epoch
+			if (hasNoise && !isProducer) {
+				noise->generate(part.first, part.last, epoch, epochEnd - epoch);
+			}
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::NOISE);
+			}
+			
+			// integrate phase: update the thread's neurons, step by step
+			int nSpiked = 0;
+			for (long step = epoch; step < epochEnd; ++step) {
+				if ((int) part.spiked.size() < nSpiked + range) {
+					part.spiked.resize(nSpiked + range);
+				}
+				
+				nSpiked += population.update(part.first, part.last, step, current->getValue(step), part.spiked.data() + nSpiked,
+											 hasNoise ? noise->getRow(step) : nullptr);
+				part.stepEnds[step - epoch] = nSpiked;
+			}
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::INTEGRATE);
+			}
+			
+			// hand the spikes of the epoch to the statistics and the recorder
+			for (long step = epoch; step < epochEnd; ++step) {
+				int begin = step > epoch ? part.stepEnds[step - epoch - 1] : 0;
+				for (int i = begin; i < part.stepEnds[step - epoch]; ++i) {
+					statistics->record(thread, step, part.spiked[i]);
+					if (recorder != nullptr) {
+						recorder->record(thread, step, part.spiked[i]);
+					}
+				}
+			}
+			if (recorder != nullptr) {
+				recorder->advance(thread, epochEnd);
+			}
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::RECORD);
+				
+				long nEvents = 0;
+				for (int i = 0; i < nSpiked; ++i) {
+					nEvents += getNbTargets(part.spiked[i]);
+				}
+				profile->count(thread, (long) range * (epochEnd - epoch), nSpiked, nEvents);
+				profile->lap(thread, Profiler::COUNT);
+			}
+			
+			// wait until all spikes of the epoch are known
+			pool->sync();
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::WAIT);
+			}
+			
+			// and those of the other ranks
+			if (transport != nullptr) {
+				if (thread == 0) {
+					try {
+						exchange(epoch, epochEnd);
+					} catch (const std::runtime_error&) {
+						failure = std::current_exception();
+					}
+				}
+				
+				// the first thread counts the events of the other ranks' spikes
+				if (profile != nullptr && thread == 0 && failure == nullptr) {
+					profile->lap(thread, Profiler::EXCHANGE);
+					
+					long nEvents = 0;
+					for (int other = 0; other < nRanks; ++other) {
+						if (other == rank)
+							continue;
+						
+						const std::vector<int32_t>& spikes = received[other];
+						for (long step = epoch; step < epochEnd; ++step) {
+							const int begin = receivedSteps[other][step - epoch] + 1;
+							for (int i = begin; i < begin + spikes[begin - 1]; ++i) {
+								nEvents += getNbTargets(spikes[i]);
+							}
+						}
+					}
+					profile->count(thread, 0, 0, nEvents);
+					profile->lap(thread, Profiler::COUNT);
+				}
+				
+				pool->sync();
+				if (profile != nullptr) {
+					profile->lap(thread, Profiler::WAIT);
+				}
+				
+				// a rank cannot go on without the others
+				if (failure != nullptr)
+					break;
+			}
+			
+			// deliver phase: transmit all spikes to the thread's targets with delay,
+			// in order of source whatever the number of ranks and threads
+			for (long step = epoch; step < epochEnd; ++step) {
+				double* arrivals = population.getIncomingRow(step + delay);
+				
+				for (int other = 0; other < nRanks; ++other) {
+					if (other != rank) {
+						const std::vector<int32_t>& spikes = received[other];
+						const int begin = receivedSteps[other][step - epoch] + 1;
+						for (int i = begin; i < begin + spikes[begin - 1]; ++i) {
+							deliver(spikes[i], arrivals, part.first, part.last);
+						}
+						continue;
+					}
+					
+					for (const Partition& sources : partitions) {
+						int begin = step > epoch ? sources.stepEnds[step - epoch - 1] : 0;
+						for (int i = begin; i < sources.stepEnds[step - epoch]; ++i) {
+							deliver(sources.spiked[i], arrivals, part.first, part.last);
+						}
+					}
+				}
+			}
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::DELIVER);
+			}
+			
+			// the buffer of this epoch is free: make sure the next epoch is ready,
+			// and let the producer start the one after
+			if (isProducer && thread == 0 && epochEnd < end) {
+				noise->wait(epochEnd);
+				
+				const long afterNext = getEpochEnd(epochEnd);
+				if (afterNext < end) {
+					noise->request(afterNext, getEpochEnd(afterNext) - afterNext);
+				}
+			}
+			
+			// wait until all spikes were delivered before the next epoch overwrites them
+			pool->sync();
+			if (profile != nullptr) {
+				profile->lap(thread, Profiler::WAIT);
+				profile->endEpoch(thread, epoch, epochEnd);
+			}
+		}
+	});
+	
+	if (failure != nullptr) {
+		std::rethrow_exception(failure);
+	}
+}
+
+
+// exchange the spikes of an epoch with the other ranks
+void Network::exchange(long epoch, long epochEnd) {
+	const int rank = transport->getRank();
+	
+	// the spikes of every step: their number, then the neurons, in increasing order
+	outgoing.clear();
+	for (long step = epoch; step < epochEnd; ++step) {
+		const std::size_t count = outgoing.size();
+		outgoing.push_back(0);
+		
+		for (const Partition& part : partitions) {
+			int begin = step > epoch ? part.stepEnds[step - epoch - 1] : 0;
+			outgoing.insert(outgoing.end(), part.spiked.begin() + begin, part.spiked.begin() + part.stepEnds[step - epoch]);
+		}
+		outgoing[count] = outgoing.size() - count - 1;
+	}
+	
+	transport->allGather(outgoing, received);
+	
+	if ((int) received.size() != transport->size())
+		throw std::runtime_error("the exchange did not return the spikes of every rank");
+	
+	// where the spikes of every step start, for every rank, whose spikes are
+	// the increasing neurons of its range and fill its data exactly
+	receivedSteps.resize(received.size());
+	for (std::size_t other = 0; other < received.size(); ++other) {
+		const std::vector<int32_t>& spikes = received[other];
+		const std::pair<int, int> range = getRange(config.getNbNeurons(), other, received.size());
+		receivedSteps[other].clear();
+		
+		std::size_t position = 0;
+		for (long step = epoch; step < epochEnd; ++step) {
+			if (position >= spikes.size() || spikes[position] < 0 || (std::size_t) spikes[position] >= spikes.size() - position)
+				throw std::runtime_error("rank " + std::to_string(other) + " sent an incomplete epoch");
+			
+			receivedSteps[other].push_back(position);
+			const std::size_t end = position + 1 + spikes[position];
+			for (std::size_t i = position + 1; i < end; ++i) {
+				if (spikes[i] < range.first || spikes[i] >= range.second || (i > position + 1 && spikes[i] <= spikes[i - 1]))
+					throw std::runtime_error("rank " + std::to_string(other) + " sent a neuron out of its range");
+			}
+			position = end;
+		}
+		
+		if (position != spikes.size())
+			throw std::runtime_error("rank " + std::to_string(other) + " sent more than an epoch");
+	}
+	
+	// the spikes of the other ranks are counted and recorded here too, by increasing neuron
+	const int lane = partitions.size();
+	for (long step = epoch; step < epochEnd; ++step) {
+		for (int other = 0; other < (int) received.size(); ++other) {
+			if (other == rank)
+				continue;
+			
+			const std::vector<int32_t>& spikes = received[other];
+			const int begin = receivedSteps[other][step - epoch] + 1;
+			for (int i = begin; i < begin + spikes[begin - 1]; ++i) {
+				population.recordSpike(spikes[i], step);
+				statistics->record(0, step, spikes[i]);
+				if (recorder != nullptr) {
+					recorder->record(lane, step, spikes[i]);
+				}
+			}
+		}
+	}
+	if (recorder != nullptr) {
+		recorder->advance(lane, epochEnd);
+	}
+}
+
+// get the number of targets of a neuron in this rank
+long Network::getNbTargets(int source) const {
+	// the stored connections only hold the targets of this rank
+	if (procedural == nullptr)
+		return synapses->getNbTargets(source);
+	
+	if (first == 0 && last == config.getNbNeurons())
+		return procedural->getNbTargets(source);
+	
+	long n = 0;
+	procedural->forEachTarget(source, first, last, [&](int) { ++n; });
+	return n;
+}
+
+// get whether this process writes the results
+bool Network::isRoot() const {
+	return transport == nullptr || transport->getRank() == 0;
+}
 
-	std::cout << '\t' << '\t' << "[done in " << t2 - t1 << " s, " << tEnd << " steps]" << std::endl;
+// get the checkpoint file of this rank
+std::string Network::getRankFile(const std::string& filename) const {
+	if (transport == nullptr)
+		return filename;
+	
+	return filename + ".rank" + std::to_string(transport->getRank()) + "of" + std::to_string(transport->size());
+}
+
+// write the state of the simulation
+bool Network::checkpoint(const std::string& name) {
+	const std::string filename = getRankFile(name);
+	
+	// the result file holds all spikes before the checkpoint, a later run continues it
+	if (recorder != nullptr) {
+		recorder->finish();
+		recorder.reset();
+		appendOutput = true;
+	}
+	
+	Checkpoint::Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, Checkpoint::MAGIC, sizeof(header.magic));
+	header.version = Checkpoint::VERSION;
+	header.byteOrder = Checkpoint::ENDIANNESS;
+	header.modelHash = config.getModelHash();
+	header.connectionsHash = config.getConnectionsHash();
+	header.step = t;
+	header.nNeurons = population.size();
+	header.outputSize = -1;
+	
+	struct stat status;
+	if (config.recordSpikes && config.streamSpikes && isRoot() && stat(config.getOutput().c_str(), &status) == 0) {
+		header.outputSize = status.st_size;
+	}
+	
+	// the next run writes over the index of a binary result file, the checkpoint keeps it
+	std::vector<char> index;
+	if (header.outputSize >= (int64_t) sizeof(SpikeFormat::Trailer) && config.format == "binary") {
+		std::ifstream output(config.getOutput(), std::ios::binary);
+		SpikeFormat::Trailer trailer;
+		output.seekg(header.outputSize - sizeof(trailer));
+		
+		if (output.read((char*) &trailer, sizeof(trailer)) &&
+			std::memcmp(trailer.magic, SpikeFormat::END, sizeof(trailer.magic)) == 0 && trailer.footer < (uint64_t) header.outputSize) {
+			index.resize(header.outputSize - trailer.footer);
+			output.seekg(trailer.footer);
+			if (!output.read(index.data(), index.size()))
+				return false;
+		}
+	}
+	
+	// replace the previous checkpoint only once the new one is complete
+	const std::string temporary = filename + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary);
+		Checkpoint::write(out, header);
+		population.save(out);
+		statistics->save(out);
+		Checkpoint::writeArray(out, index);
+		
+		if (!out.flush())
+			return false;
+	}
+	
+	return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+// resume from a checkpoint
+void Network::restore(const std::string& name) {
+	const std::string filename = getRankFile(name);
+	
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("cannot open checkpoint '" + filename + "'");
+	
+	Checkpoint::Header header;
+	Checkpoint::read(in, header);
+	
+	if (std::memcmp(header.magic, Checkpoint::MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != Checkpoint::VERSION || header.byteOrder != Checkpoint::ENDIANNESS)
+		throw std::runtime_error("'" + filename + "' is not a checkpoint of this version and architecture");
+	
+	if (header.modelHash != config.getModelHash() || header.connectionsHash != config.getConnectionsHash() ||
+		header.nNeurons != (uint64_t) population.size())
+		throw std::runtime_error("checkpoint '" + filename + "' was written by a network with other parameters");
+	
+	if (header.step > tEnd)
+		throw std::runtime_error("checkpoint '" + filename + "' is after the end of the simulation");
+	
+	population.load(in);
+	statistics->load(in);
+	std::vector<char> index;
+	Checkpoint::readArray(in, index);
+	t = header.step;
+	
+	// the streamed result file continues as it was at the checkpoint, with its index
+	if (config.recordSpikes && config.streamSpikes && isRoot() && header.outputSize >= 0) {
+		if ((int64_t) index.size() > header.outputSize ||
+			truncate(config.getOutput().c_str(), header.outputSize - index.size()) != 0)
+			throw std::runtime_error("cannot restore the result file '" + config.getOutput() + "'");
+		
+		if (!index.empty()) {
+			std::ofstream output(config.getOutput(), std::ios::binary | std::ios::app);
+			if (!output.write(index.data(), index.size()))
+				throw std::runtime_error("cannot restore the result file '" + config.getOutput() + "'");
+		}
+		appendOutput = true;
+	}
+	
+	if (config.verbose) {
+		std::cout << "Restoring..." << '\t' << "[step " << t << " from '" << filename << "']" << std::endl;
+	}
+}
+
+
+void Network::deliver(int source, double* arrivals, int firstTarget, int lastTarget) const {
+	double pot = population.getTransmissionValue(source);
+	
+	// regenerate the targets in the range, the row starts at the first neuron of this rank
+	if (procedural != nullptr) {
+		procedural->forEachTarget(source, firstTarget, lastTarget, [&](int target) { arrivals[target - first] += pot; });
+		return;
+	}
+	
+	synapses->forEachTarget(source, firstTarget, lastTarget, [&](int target) { arrivals[target - first] += pot; });
 }
 
 
 void Network::save() const {
-	std::cout << "Saving..." << std::flush;
+	// the first rank knows all spikes
+	if (!isRoot())
+		return;
 	
-	// open result file
-	std::ofstream log;
+	if (config.verbose) {
+		std::cout << "Saving..." << std::flush;
+	}
 	
-	// create filename
-	std::stringstream ss;
-	ss << "../results/spikes" << 
-		"_eta" << C::ETA <<
-		"_g" << C::G <<
-		".gdf";
-	std::string filename = ss.str(); 
+	// the statistics replace the spikes, or come with them
+	if (!config.statistics.empty()) {
+		std::ofstream out(config.statistics);
+		if (!out) {
+			std::cerr << "Warning: cannot write the statistics file '" << config.statistics << "'" << std::endl;
+		}
+		statistics->write(out);
+	}
 	
-	log.open(filename);
+	if (!config.recordSpikes) {
+		if (config.verbose) {
+			std::cout << '\t' << '\t' << "[" << statistics->getRate() << " Hz, spikes not recorded]" << std::endl;
+		}
+		return;
+	}
 	
-	// make sure neurons were initialised
-	assert(neurons[0] != nullptr);
+	// already written while simulating
+	if (config.streamSpikes) {
+		if (config.verbose) {
+			std::cout << '\t' << '\t' << "[streamed to file '" << config.getOutput() << "']" << std::endl;
+		}
+		return;
+	}
 	
-	// write each spike to the file
-	for (int i = 0; i < (int) neurons.size(); ++i) {
-		for (auto spikeTime : neurons.at(i)->getSpikeTimes()) {
-			log << spikeTime << '\t' << i << '\n';
+	// all spikes, in order of time then neuron: k-way merge of the spike times
+	// of every neuron, already in order, with the next spike of each neuron in a heap
+	typedef std::pair<long, int> Head;
+	std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+	std::vector<std::size_t> next(population.size(), 0);
+	std::size_t nSpikes = 0;
+	
+	for (int i = 0; i < population.size(); ++i) {
+		const auto& times = population.getSpikeTimes(i);
+		if (!times.empty()) {
+			heads.push(Head(times[0], i));
+			nSpikes += times.size();
 		}
 	}
 	
-	std::cout << '\t' << '\t' << "[saved to file '" << filename << "']" << std::endl;
-	log.close();
+	std::vector<Spike> spikes;
+	spikes.reserve(nSpikes);
+	while (!heads.empty()) {
+		const Head head = heads.top();
+		heads.pop();
+		spikes.push_back({ head.first, head.second });
+		
+		const auto& times = population.getSpikeTimes(head.second);
+		if (++next[head.second] < times.size()) {
+			heads.push(Head(times[next[head.second]], head.second));
+		}
+	}
+	
+	// create filename
+	std::string filename = config.getOutput(); 
+	
+	// write each spike to the file
+	auto output = SpikeWriter::open(filename, config.format, population.size(), config.nThreads);
+	output->write(spikes.data(), spikes.size());
+	output->close(t);
+	
+	if (config.verbose) {
+		std::cout << '\t' << '\t' << "[saved to file '" << filename << "']" << std::endl;
+	}
 }
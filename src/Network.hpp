@@ -2,12 +2,23 @@
 #define NETWORK_H
 
 #include <vector>
+#include <string>
 #include <array>
-#include <random>
 #include <algorithm>
 #include <cassert>
+#include <memory>
 #include "Current.hpp"
-#include "Neuron.hpp"
+#include "NeuronPopulation.hpp"
+#include "SynapseMatrix.hpp"
+#include "ProceduralConnections.hpp"
+#include "ThreadPool.hpp"
+#include "NoisePipeline.hpp"
+#include "SpikeRecorder.hpp"
+#include "PopulationStatistics.hpp"
+#include "Profiler.hpp"
+#include "Transport.hpp"
+#include "Config.hpp"
+#include "Philox.hpp"
 #include "Constants.hpp"
 
 /** \brief Class representing a Network
@@ -21,100 +32,281 @@ public:
 	 * Initializes a new network
 	 * 
 	 * \param current		 	a Current object (I)
-	 * \param duration			length of the simulation in number of time steps
+	 * \param config			the model and simulation parameters
 	 */
-	Network(Current* current, long duration = 10000);
+	Network(Current* current, const Config& config = Config());
 	
-	/// Network destructor: safely removes dynamically allocated neuron objects
-	virtual ~Network();
+	/*! \brief Network constructor, with existing connections
+	 *
+	 * Initializes a new network on top of connections shared with other networks,
+	 * e.g. simulations of several parameter points with the same connectome.
+	 * 
+	 * \param current		 	a Current object (I)
+	 * \param config			the model and simulation parameters
+	 * \param synapses			the connections, built for the same neurons,
+	 * 							nullptr with Config::proceduralConnections
+	 * \param transport			connects the ranks of a distributed simulation, nullptr for one process;
+	 * 							the connections then need to hold those to the neurons of this rank only
+	 */
+	Network(Current* current, const Config& config, std::shared_ptr<const SynapseMatrix> synapses,
+			Transport* transport = nullptr);
+	
+	/*! \brief Network constructor, for one rank of a distributed simulation
+	 *
+	 * Every rank updates the neurons of its range (see getRange()) and only draws
+	 * their incoming connections. After the integration of every epoch, the ranks exchange
+	 * their spikes through the transport, and deliver the spikes of all ranks
+	 * in the same order as a single process: the spikes are exactly the same.
+	 * All ranks count all spikes, the first rank writes the results.
+	 * 
+	 * \param current		 	a Current object (I)
+	 * \param config			the model and simulation parameters, the same on all ranks
+	 * \param transport		connects the ranks, must outlive the network
+	 */
+	Network(Current* current, const Config& config, Transport& transport);
+	
+	/// Default destructor
+	virtual ~Network() = default;
 	
 	/*! \brief Run the simulation
 	 *
 	 * Updates each neuron with the given current for 
-	 * the specified number of time steps
+	 * the specified number of time steps.
+	 * Every spike arrives after the transmission delay,
+	 * so the simulation advances by epochs of that many steps:
+	 * every thread updates its own range of neurons through the whole epoch,
+	 * then delivers the spikes of the whole network to the targets in its range,
+	 * so that threads only synchronise twice per epoch and never write the same memory.
+	 *
+	 * With Config::checkpoint, a checkpoint is written every Config::checkpointInterval
+	 * steps and at the end.
+	 *
+	 * With Config::profile, in a build with the PROFILING option, the time spent
+	 * in every phase is written to that file at the end, see Profiler.
+	 * With Config::trace, the phases, epochs and writes of the spikes
+	 * of every thread are written to that file as a Chrome trace, see Tracer.
+	 *
+	 * A failed exchange with the other ranks raises std::runtime_error, once all threads stopped.
 	 */
 	void run();
 	
+	/*! \brief Write the state of the simulation to a checkpoint file
+	 *
+	 * The potentials, refractory steps, pending incoming potentials, spike counts
+	 * and history, statistics and step of the simulation, with hashes of the parameters
+	 * and the connections it needs. The background noise is counter-based,
+	 * so its state is the step. A streamed result file is completed first,
+	 * and its size recorded. The index of a binary result file is kept too,
+	 * since the next run writes over it. The previous checkpoint is only replaced
+	 * once the new one is complete.
+	 *
+	 * \return false if the file could not be written
+	 */
+	bool checkpoint(const std::string& filename);
+	
+	/*! \brief Resume from a checkpoint file, before run()
+	 *
+	 * The network must have the same parameters, except for the duration, the number of threads
+	 * and the outputs: the simulation then continues exactly as if it had not stopped.
+	 * Every rank of a distributed simulation has a checkpoint file of its own.
+	 * A streamed result file is cut back to its spikes at the checkpoint, its index restored, and continued.
+	 * Errors raise std::runtime_error.
+	 */
+	void restore(const std::string& filename);
+	
 	/*! \brief Export results to file
 	 *
 	 * Stores the results of the simulation (all spikes and when they happened)
-	 * in a file with the following format:
+	 * in order of time, then neuron, in the format of Config::format:
+	 * text lines with the following format, or the binary format read by SpikeReader.
 	 * 
 	 * [step at which a spike happened][tab][index of the spiking Neuron]
+	 *
+	 * With Config::streamSpikes, the spikes were already written during run(),
+	 * without Config::recordSpikes, they are not written at all.
+	 * With Config::statistics, the population statistics are written to that file.
 	 */
 	void save() const;
 	
+	/// Get the parameters of the simulation
+	const Config& getConfig() const;
+	
+	/// Get the population holding the state of the neurons of this rank, and the spikes of all neurons
+	const NeuronPopulation& getPopulation() const;
+	
+	/// Get the connections between the neurons, unless they are procedural
+	const SynapseMatrix& getSynapses() const;
 	
-	/*! \brief Generate random background noise
+	/// Get the statistics of the spikes, complete after run(), with the intervals of the neurons of this rank, or of all on the first rank
+	const PopulationStatistics& getStatistics() const;
+	
+	/*! \brief Get the number of synaptic events of the simulation so far
 	 *
-	 *  Uses the mt19937 generator, follows a poisson distribution
+	 * Every spike of a neuron is one event at each of its targets, counted from
+	 * the spikes of every neuron, at the targets of this rank only in a distributed simulation.
 	 */
-	static double getBackgroundNoise() {
-		// get random device
-		static std::random_device randomDevice;
-		
-		// init random generator
-		static std::mt19937 gen(randomDevice());
-		
-		// init poisson distribution
-		static std::poisson_distribution<> poissonGen(C::V_EXT * C::STEP_DURATION);
-		
-		// number of spikes during one step
-		int nSpikes = poissonGen(gen);
-		
-		// background noise is number of spikes times J
-		return nSpikes * C::J_EXCITATORY;
-	}
+	long getNbSynapticEvents() const;
+	
+	/*! \brief Draws the random connections of a network
+	 *
+	 * The connections only depend on the sizes of the populations, the connectivity
+	 * and the seed, so they can be shared by all networks with these parameters.
+	 * They are drawn on Config::nThreads threads, and do not depend on their number.
+	 * With Config::connectionCache, they are mapped from the cache if it was built
+	 * from the same parameters, otherwise they are drawn and the cache is replaced.
+	 *
+	 * With a range of targets, only the connections to these neurons are drawn,
+	 * and cached in a file of their own.
+	 *
+	 * \param config			the parameters of the network
+	 * \param firstTarget		the first neuron whose incoming connections are drawn
+	 * \param lastTarget		the neuron after the last one, -1 for all neurons
+	 */
+	static std::shared_ptr<const SynapseMatrix> createSynapses(const Config& config, int firstTarget = 0, int lastTarget = -1);
+	
+	/*! \brief Get the neurons of one rank of a distributed simulation
+	 *
+	 * \return the range [first, last) of neurons of rank \p rank of \p nRanks, in whole cache lines
+	 */
+	static std::pair<int, int> getRange(int nNeurons, int rank, int nRanks);
 	
 protected:
 
-	/*! \brief Creates random connections and assigns them to the Neurons
+	/*! \brief Draws random connection sources
 	 *
-	 *  Fills a fixed-size table with uniformly distributed values 
+	 *  Fills \p table with \p size uniformly distributed values 
 	 *  between \p min and \p max.
-	 * 	The generated numbers represent the indices of the sources of the neuron at index \p idx.
-	 *  Assigns the neuron at index \p idx as target of the generated sources.
+	 * 	The generated numbers represent the indices of the sources of one neuron.
+	 *  Every neuron and stream has its own random sequence, so the sources
+	 *  of different neurons can be drawn in any order, on any thread.
 	 * 
-	 * \param table		 	array of any size, determines the amount of numbers generated
-	 * \param idx			index of target neurons
+	 * \param generator		random generator, keyed with the seed
+	 * \param neuron		index of the neuron
+	 * \param stream		random stream, one of Stream
+	 * \param table		 	destination of the generated sources
+	 * \param size			amount of numbers generated
 	 * \param min			lower bound for random number generation
 	 * \param max			upper bound for random number generation
 	 */
-	template<std::size_t SIZE>
-	void createConnections(std::array<int, SIZE>& table, int idx, int min, int max) {
-		// init random engine and distribution
-		static std::default_random_engine engine;
-		std::uniform_int_distribution<int> distr(min, max);
+	static void createConnections(const Philox& generator, int neuron, uint32_t stream, int* table, int size, int min, int max) {
+		if (size == 0)
+			return;
+		
+		// multiply and reject the low words under the threshold: unbiased and without division
+		const uint32_t range = max - min + 1;
+		const uint32_t threshold = -range % range;
 
-		// fill table with generated values
-		std::generate(
-			table.begin(),
-			table.end(), 
-			[&]() { 				
-				return distr(engine); 
+		uint32_t block = 0;
+		for (int k = 0; k < size; ++block) {
+			Philox::Block bits = generator(neuron, block, 0, stream);
+
+			for (int i = 0; i < 4 && k < size; ++i) {
+				uint64_t product = (uint64_t) bits.v[i] * range;
+				if ((uint32_t) product >= threshold) {
+					table[k++] = min + (int) (product >> 32);
+				}
 			}
-		);
-		
-		// assign to connection vector
-		for (int source : table) {
-			// check for correct index
-			assert(source < (int) neurons.size());
-			
-			// assign new target to source
-			neurons[source]->addConnectionTarget(idx);
 		}
 	}
 
 private:
 
+	/// Connections of a network, and when the constructor drew or mapped them
+	struct Connections {
+		std::shared_ptr<const SynapseMatrix> synapses;	//!< the stored connections, nullptr if procedural
+		Profiler::Clock::time_point start;				//!< start of the network constructor
+		Profiler::Clock::time_point end;				//!< end of drawing or mapping the connections
+	};
+	
+	/// Network constructor, on connections drawn or given by the public constructors
+	Network(Current* current, const Config& config, const Connections& connections, Transport* transport);
+	
+	/// Draw or map the connections to the neurons [firstTarget, lastTarget), unless procedural, and time it
+	static Connections connect(const Config& config, int firstTarget = 0, int lastTarget = -1);
+	
+	/// Get connections given to the constructor, which took no time to draw
+	static Connections share(std::shared_ptr<const SynapseMatrix> synapses);
+	
+	/// Range of neurons updated by one thread, and its spikes of the current epoch
+	struct Partition {
+		int first, last;				//!< the thread's neurons are in [first, last)
+		std::vector<int> spiked;		//!< neurons of the range which spiked, step after step
+		std::vector<int> stepEnds;		//!< end of the spikes of every step of the epoch in spiked
+	};
+	
+	/*! \brief Main simulation loop
+	 *
+	 * \tparam DELAY		the transmission delay if known at compile time, 0 otherwise
+	 * \param end			the step to simulate until, from the current time
+	 */
+	template<int DELAY>
+	void simulate(long end);
+	
+	/*! \brief Deliver a spike to the targets in a range of neurons
+	 *
+	 * \param source		index of the spiking neuron
+	 * \param arrivals		incoming potentials at the arrival time of the spike, from the first neuron of this rank
+	 * \param firstTarget	index of the first target to deliver to
+	 * \param lastTarget	index after the last target to deliver to
+	 */
+	void deliver(int source, double* arrivals, int firstTarget, int lastTarget) const;
+	
+	/*! \brief Exchange the spikes of an epoch with the other ranks
+	 *
+	 * Sends the spikes of all threads, receives those of the other ranks,
+	 * and counts and records them, on the first thread between two synchronisations.
+	 */
+	void exchange(long epoch, long epochEnd);
+	
+	/// Get the number of targets of neuron \p source among the neurons of this rank
+	long getNbTargets(int source) const;
+	
+	/// Get whether this process writes the results: it is the first rank, or the only one
+	bool isRoot() const;
+	
+	/// Get the file of this rank, e.g. a checkpoint, with its index if there are several
+	std::string getRankFile(const std::string& filename) const;
+	
+	Config config;								//!< the simulation's parameters
+	
+	std::unique_ptr<Tracer> tracer;				//!< timeline of the threads, with Config::trace in a PROFILING build
+	std::unique_ptr<Profiler> profiler;			//!< time of every phase, with Config::profile or Config::trace in a PROFILING build
+	
 	Current* current; 							//!< the simulation's current (I)
 
 	long t, tEnd;								//!< current time, ending time
 
-	/** all neurons in the network, where the first C::N_EXCITATORY neurons are excitatory,
-	 *  and the rest are inhibitory
+	int first, last;							//!< neurons of this rank
+
+	/** all neurons in the network, where the first excitatory neurons are excitatory,
+	 *  and the rest are inhibitory; only the state of the neurons of this rank is kept
 	 * */
-	std::array<Neuron*, C::N_TOTAL> neurons; 
+	NeuronPopulation population;
+	
+	/// target connections of every neuron - index of target neuron in the population, read only
+	std::shared_ptr<const SynapseMatrix> synapses;
+	
+	/// target connections regenerated when a neuron spikes, if Config::proceduralConnections is set
+	std::unique_ptr<ProceduralConnections> procedural;
+	
+	/** background noise of the neurons of this rank, generated one epoch ahead
+	 *  by the simulation threads, or by a producer thread if Config::noiseProducer is set
+	 * */
+	std::unique_ptr<NoisePipeline> noise;
+	
+	std::unique_ptr<ThreadPool> pool;			//!< threads running the simulation
+	
+	std::unique_ptr<SpikeRecorder> recorder;	//!< writes the spikes during run(), if Config::streamSpikes is set
+	bool appendOutput;							//!< the recorder continues an existing result file
+	
+	std::unique_ptr<PopulationStatistics> statistics;	//!< statistics of the spikes, updated during run()
+	
+	Transport* transport;						//!< connects the ranks of a distributed simulation, nullptr for one process
+	std::vector<int32_t> outgoing;				//!< spikes of this rank sent during an exchange
+	std::vector<std::vector<int32_t>> received;	//!< spikes of every rank received during an exchange
+	std::vector<std::vector<int>> receivedSteps;	//!< start of every step in the spikes of every rank
+	
+	std::vector<Partition> partitions;			//!< neurons of every thread
 
 };
 
@@ -1,24 +1,8 @@
-#include <cmath>
-#include <iostream>
 #include "Neuron.hpp"
-#include "Network.hpp"
 
 Neuron::Neuron(bool type, double t, double r)
-	: tau(t), resistance(r), capacity(r != 0 ? t / r : C::MEMBRANE_CAPACITY),
-	  potential(C::V_REST), 
-	  clock(0),
-	  typeExcitatory(type)
+	: population(std::make_shared<NeuronPopulation>(1, type ? 1 : 0, t, r))
 {
-	// spikes, empty
-	spikes = { };
-	
-	// ODE integration constants, calculated once
-	c1 = exp(- C::STEP_DURATION / tau);
-	c2 = resistance * (1.0 - c1);
-	
-	// incoming potential buffer, zero-initalised
-	incomingBuffer = { };
-	
 	// connections, empty
 	connections = { };
 }
@@ -26,24 +10,24 @@ Neuron::Neuron(bool type, double t, double r)
 
 // get the current membrane potential
 double Neuron::getPotential() const {
-	return potential;
+	return population->getPotential(0);
 }
 
 // get the neuron's clock
 long Neuron::getClock() const {
-	return clock;
+	return population->getClock();
 }
 
 // get number of previous spikes
 int Neuron::getNbSpikes() const {
-	return spikes.empty() ? 0 : spikes.size();
+	return population->getNbSpikes(0);
 }
 
 // returns time of given previous spike
 long Neuron::getSpikeTime(int index) const {
 	// if the index is valid, return the time of the spike
 	if (index >= 0 && index < getNbSpikes()) {
-		return spikes.at(index);
+		return population->getSpikeTimes(0).at(index);
 	}
 	// otherwise, return minus two times the refractory time
 	// note: this value is used to make sure the neuron is not in refractory mode by error
@@ -51,25 +35,23 @@ long Neuron::getSpikeTime(int index) const {
 }
 // returns all previous spikes
 std::vector<long> Neuron::getSpikeTimes() const {
-	return spikes;
+	return population->getSpikeTimes(0);
 }
 
 // check if neuron is still in refractory mode
-bool Neuron::isRefractory() const {	
-	// the neuron is refractory if there was a spike in the last
-	// C::REFRACTORY_TIME amount of steps 
-	return !spikes.empty() && clock - spikes.back() < C::REFRACTORY_TIME;
+bool Neuron::isRefractory() const {
+	return population->isRefractory(0);
 }
 
 
 // get if the neuron is refractory
 bool Neuron::isExcitatory() const {
-	return typeExcitatory;
+	return population->isExcitatory(0);
 }
 
 // get the post-synaptic transmission value
 double Neuron::getTransmissionValue() const {
-	return isExcitatory() ? C::J_EXCITATORY : C::J_INHIBITORY;
+	return population->getTransmissionValue(0);
 }
 
 // add a connection target
@@ -84,56 +66,20 @@ const std::vector<int>& Neuron::getConnectionTargets() const {
 
 // receive incoming spike
 void Neuron::receive(double pot, long arrival) {
-	// buffered transmission
-	incomingBuffer[arrival % incomingBuffer.size()] += pot;
+	population->receive(0, pot, arrival);
 }
 
 // main update function
 bool Neuron::update(int steps, double current) {
 	bool spiked = false;
-	
+
 	for (int i = 0; i < steps; ++i) {
-		// if the potential is over the threshold, emit a spike
-		if (potential >= C::V_THRESHOLD) {
-			fire();
+		// the population reports the neuron if it spiked during this step
+		if (!population->update(current).empty()) {
 			spiked = true;
 		}
-		
-		if (!isRefractory()) {
-			// update the potential
-			updatePotential(current);
-		}
-		
-		// reset incoming buffer field
-		incomingBuffer[clock % incomingBuffer.size()] = 0.0;
-		
-		// increment clock
-		++clock;
 	}
-	
+
 	// return whether the neuron spiked
 	return spiked;
 }
-
-// update the neuron's potential
-void Neuron::updatePotential(double current) {
-	// update the potential according to the general formula
-	potential = c1 * potential + c2 * current;
-	
-	// incoming spikes
-	potential += incomingBuffer[clock % incomingBuffer.size()];
-	
-	// background noise
-	if (C::IS_BACKGROUND_NOISE)
-		potential += Network::getBackgroundNoise();
-}
-
-// the neurons emits a spike
-void Neuron::fire() {
-	// add new spike to the list 
-	spikes.push_back(clock);
-
-	// reset the membrane potential
-	potential = C::V_REST;
-}
-
@@ -2,14 +2,17 @@
 #define NEURON_H
 
 #include <vector>
-#include <array>
+#include <memory>
 #include "Constants.hpp"
+#include "NeuronPopulation.hpp"
 
-// Circular dependency resolution
-class Network;
 
-
-/// Class representing a Neuron
+/** \brief Class representing a Neuron
+ *
+ * Thin view on a NeuronPopulation of size one: the neuron's state lives
+ * in the population's arrays. The Network works on its population directly,
+ * this class is kept for single-neuron experiments and unit tests.
+ * */
 class Neuron {
 	
 public:
@@ -25,10 +28,7 @@ public:
 	 */
 	Neuron(bool typeExcitatory = true, double tau = C::TAU, double resistance = C::MEMBRANE_RESISTANCE);
 	
-	/// Default destructor
-	virtual ~Neuron() = default;
-	
-	
+
 	/// Get the neuron's current membrane potential
 	double getPotential() const;
 	
@@ -108,38 +108,10 @@ public:
 	 */
 	bool update(int steps, double current);
 	
-protected:
-
-	/*! \brief Updates the neuron's membrane potential
-	 *
-	 * Updates the neuron's membrane potential according to the general formula,
-	 * adds any transmitted potential from the ring buffer,
-	 * adds random background noise
-	 */
-	void updatePotential(double current);
-	
-	/// Adds a spike to the list of previous spikes
-	void fire();
-	
-
 private:
 	
-	double tau;						//!< characteristic circuit constant	
-	double resistance;				//!< the membrane's resistance
-	double capacity;				//!< the membrane's capacity
-
-	double potential;				//!< the neuron's membrane potential, initialised to 0.0
-	
-	long clock;						//!< neuron's internal clock, initialised to 0
-
-	bool typeExcitatory; 			//!< circular incoming buffer
-
-	std::vector<long> spikes; 		//!< a vector containing all the neuron's previous spikes
-	
-	double c1, c2;					//!< integration constants
-	
-	/// circular incoming buffer
-	std::array<double, C::TRANSMISSION_BUFFER_SIZE> incomingBuffer;
+	/// the neuron's state, shared between copies of the view
+	std::shared_ptr<NeuronPopulation> population;
 	
 	/// target connections - index of target neuron in the Network's list of Neurons
 	std::vector<int> connections; 	
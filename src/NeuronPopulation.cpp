@@ -0,0 +1,217 @@
+#include <cmath>
+#include <cassert>
+#include "NeuronPopulation.hpp"
+#include "IntegrationKernel.hpp"
+#include "Checkpoint.hpp"
+
+namespace {
+	/// Default configuration, with the given sizes and membrane constants
+	Config makeConfig(int size, int nExcitatory, double tau, double resistance, uint64_t seed) {
+		Config config;
+		config.nExcitatory = nExcitatory;
+		config.nInhibitory = size - nExcitatory;
+		config.tau = tau;
+		config.resistance = resistance;
+		config.seed = seed;
+		return config;
+	}
+}
+
+NeuronPopulation::NeuronPopulation(int size, int nExc, double tau, double resistance, uint64_t seed)
+	: NeuronPopulation(makeConfig(size, nExc, tau, resistance, seed))
+{}
+
+NeuronPopulation::NeuronPopulation(const Config& config, int first, int last)
+	: nNeurons(config.getNbNeurons()),
+	  firstNeuron(first), lastNeuron(last < 0 ? nNeurons : last),
+	  nExcitatory(config.nExcitatory),
+	  threshold(config.threshold), reset(config.reset), refractoryTime(config.refractoryTime),
+	  jExcitatory(config.j), jInhibitory(config.getJInhibitory()),
+	  hasNoise(config.backgroundNoise),
+	  clock(0),
+	  potentials(lastNeuron - firstNeuron, config.reset),
+	  refractory(lastNeuron - firstNeuron, 0),
+	  incoming(lastNeuron - firstNeuron, config.delay + 1),
+	  noise(config.seed, config.getExternalSpikesPerStep(), config.j),
+	  hasHistory(true), spikes(nNeurons), nSpikes(nNeurons, 0)
+{
+	assert(0 <= nExcitatory && nExcitatory <= nNeurons);
+	assert(0 <= firstNeuron && firstNeuron <= lastNeuron && lastNeuron <= nNeurons);
+
+	// ODE integration constants, calculated once
+	c1 = exp(- config.stepDuration / config.tau);
+	c2 = config.resistance * (1.0 - c1);
+}
+
+
+// get the number of neurons
+int NeuronPopulation::size() const {
+	return nNeurons;
+}
+
+// get the first neuron whose state is kept
+int NeuronPopulation::getFirst() const {
+	return firstNeuron;
+}
+
+// get the neuron after the last one whose state is kept
+int NeuronPopulation::getLast() const {
+	return lastNeuron;
+}
+
+// get the population's clock
+long NeuronPopulation::getClock() const {
+	return clock;
+}
+
+// get the membrane potential of a neuron
+double NeuronPopulation::getPotential(int idx) const {
+	assert(firstNeuron <= idx && idx < lastNeuron);
+	return potentials[idx - firstNeuron];
+}
+
+// get the number of previous spikes of a neuron
+int NeuronPopulation::getNbSpikes(int idx) const {
+	return nSpikes[idx];
+}
+
+// get all previous spikes of a neuron
+const std::vector<long>& NeuronPopulation::getSpikeTimes(int idx) const {
+	return spikes[idx];
+}
+
+// a neuron is refractory while it has remaining refractory steps
+bool NeuronPopulation::isRefractory(int idx) const {
+	assert(firstNeuron <= idx && idx < lastNeuron);
+	return refractory[idx - firstNeuron] > 0;
+}
+
+// excitatory neurons are stored first
+bool NeuronPopulation::isExcitatory(int idx) const {
+	return idx < nExcitatory;
+}
+
+// get the post-synaptic transmission value
+double NeuronPopulation::getTransmissionValue(int idx) const {
+	return isExcitatory(idx) ? jExcitatory : jInhibitory;
+}
+
+// get the background noise
+const BackgroundNoise& NeuronPopulation::getNoise() const {
+	return noise;
+}
+
+// receive incoming spike
+void NeuronPopulation::receive(int idx, double pot, long arrival) {
+	// buffered transmission
+	assert(firstNeuron <= idx && idx < lastNeuron);
+	incoming.add(idx - firstNeuron, pot, arrival);
+}
+
+// get the incoming potentials at a given time
+double* NeuronPopulation::getIncomingRow(long arrival) {
+	return incoming.getRow(arrival);
+}
+
+// advance every kept neuron by one step
+const std::vector<int>& NeuronPopulation::update(double current) {
+	spiked.resize(lastNeuron - firstNeuron);
+	spiked.resize(update(firstNeuron, lastNeuron, clock, current, spiked.data()));
+
+	// increment clock
+	tick();
+
+	return spiked;
+}
+
+// advance a range of neurons by one step
+int NeuronPopulation::update(int first, int last, long time, double current, int* spiked, const double* pregenerated) {
+	assert(firstNeuron <= first && first <= last && last <= lastNeuron);
+
+	// this step's input of every kept neuron, cleared by the kernel
+	double* input = incoming.getRow(time);
+
+	// the arrays of the kept neurons start at the first one
+	const int begin = first - firstNeuron;
+	const int end = last - firstNeuron;
+
+	// background noise
+	if (hasNoise) {
+		if (pregenerated != nullptr) {
+			for (int i = begin; i < end; ++i) {
+				input[i] += pregenerated[i];
+			}
+		} else {
+			noise.add(first, last, time, input, firstNeuron);
+		}
+	}
+
+	// fire, integrate and count down refractory periods
+	const Kernel::Parameters params = { c1, c2 * current, threshold, reset, refractoryTime };
+	int nSpiked = Kernel::integrate(params, begin, end,
+									potentials.data(), refractory.data(), input, spiked);
+
+	for (int i = 0; i < nSpiked; ++i) {
+		spiked[i] += firstNeuron;
+		++nSpikes[spiked[i]];
+		if (hasHistory) {
+			spikes[spiked[i]].push_back(time);
+		}
+	}
+
+	return nSpiked;
+}
+
+// keep the times of all spikes or only count them
+void NeuronPopulation::setSpikeHistory(bool keep) {
+	hasHistory = keep;
+}
+
+// count a spike of a neuron updated elsewhere
+void NeuronPopulation::recordSpike(int idx, long time) {
+	++nSpikes[idx];
+	if (hasHistory) {
+		spikes[idx].push_back(time);
+	}
+}
+
+// increment the clock
+void NeuronPopulation::tick(int steps) {
+	clock += steps;
+}
+
+// write the state of the kept neurons and the spikes of all neurons
+void NeuronPopulation::save(std::ostream& out) const {
+	Checkpoint::write(out, (int64_t) clock);
+	Checkpoint::writeArray(out, potentials);
+	Checkpoint::writeArray(out, refractory);
+	incoming.save(out);
+	Checkpoint::writeArray(out, nSpikes);
+
+	Checkpoint::write(out, (uint8_t) hasHistory);
+	if (hasHistory) {
+		for (const std::vector<long>& times : spikes) {
+			Checkpoint::writeArray(out, times);
+		}
+	}
+}
+
+// read the state of all neurons
+void NeuronPopulation::load(std::istream& in) {
+	int64_t step;
+	Checkpoint::read(in, step);
+	clock = step;
+
+	Checkpoint::readArray(in, potentials, lastNeuron - firstNeuron);
+	Checkpoint::readArray(in, refractory, lastNeuron - firstNeuron);
+	incoming.load(in);
+	Checkpoint::readArray(in, nSpikes, nNeurons);
+
+	// the history is restored if both keep it
+	uint8_t hadHistory;
+	Checkpoint::read(in, hadHistory);
+	std::vector<long> times;
+	for (int i = 0; hadHistory && i < nNeurons; ++i) {
+		Checkpoint::readArray(in, hasHistory ? spikes[i] : times);
+	}
+}
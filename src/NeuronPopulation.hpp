@@ -0,0 +1,189 @@
+#ifndef NEURON_POPULATION_H
+#define NEURON_POPULATION_H
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include "AlignedAllocator.hpp"
+#include "DelayRingBuffer.hpp"
+#include "BackgroundNoise.hpp"
+#include "Config.hpp"
+#include "Constants.hpp"
+
+/** \brief Storage engine for a population of neurons
+ *
+ * Keeps the state of all neurons in contiguous, aligned arrays
+ * (structure of arrays) instead of one object per neuron, so that
+ * one simulation step is a linear pass over memory.
+ * All neurons share the same membrane constants.
+ * The first excitatory neurons come first, the rest are inhibitory.
+ *
+ * A population can keep the state of a range of the neurons of a network only,
+ * e.g. those of one rank: neurons keep their index in the network, and the
+ * rows of incoming potentials and of noise start at the first neuron of the range.
+ * The spikes of all neurons are counted.
+ * */
+class NeuronPopulation {
+
+public:
+	/*! \brief NeuronPopulation constructor
+	 *
+	 * \param size				number of neurons in the population
+	 * \param nExcitatory		number of excitatory neurons, stored first
+	 * \param tau				the neurons' membrane constant
+	 * \param resistance		the neurons' membrane resistance
+	 * \param seed				seed of the background noise
+	 */
+	NeuronPopulation(int size, int nExcitatory, double tau = C::TAU, double resistance = C::MEMBRANE_RESISTANCE,
+					 uint64_t seed = C::SEED);
+	
+	/*! \brief NeuronPopulation constructor
+	 *
+	 * \param config			the model parameters and sizes
+	 * \param first			index of the first neuron whose state is kept
+	 * \param last			index after the last neuron whose state is kept, -1 for all neurons
+	 */
+	explicit NeuronPopulation(const Config& config, int first = 0, int last = -1);
+
+
+	/// Get the number of neurons in the population
+	int size() const;
+
+	/// Get the index of the first neuron whose state is kept
+	int getFirst() const;
+
+	/// Get the index after the last neuron whose state is kept
+	int getLast() const;
+
+	/// Get the population's clock, shared by all neurons
+	long getClock() const;
+
+	/// Get the membrane potential of neuron \p idx, whose state is kept
+	double getPotential(int idx) const;
+
+	/// Get the number of previous spikes of neuron \p idx
+	int getNbSpikes(int idx) const;
+
+	/// Get all past spikes of neuron \p idx, empty if the spike history is not kept
+	const std::vector<long>& getSpikeTimes(int idx) const;
+
+	/*! \brief Keep the times of all spikes, or only count them
+	 *
+	 * The history grows with the length of the simulation,
+	 * it can be turned off when the spikes are recorded elsewhere.
+	 */
+	void setSpikeHistory(bool keep);
+
+	/// Get whether neuron \p idx, whose state is kept, is refractory
+	bool isRefractory(int idx) const;
+
+	/// Get whether neuron \p idx is excitatory
+	bool isExcitatory(int idx) const;
+
+	/*! \brief Get the potential delivered to the targets of neuron \p idx after a spike
+	 *
+	 *  \return The excitatory or inhibitory transmission value
+	 */
+	double getTransmissionValue(int idx) const;
+	
+	/// Get the random input from the external neurons
+	const BackgroundNoise& getNoise() const;
+
+
+	/*! \brief Receive an incoming spike
+	 *
+	 * Adds a transmission potential to the circular buffer of neuron \p idx
+	 *
+	 * \param idx		index of the receiving neuron, whose state is kept
+	 * \param pot		the potential transmitted post-synaptically from the spiking neuron
+	 * \param arrival	the time of arrival of the spike, seen from the simulation clock
+	 */
+	void receive(int idx, double pot, long arrival);
+	
+	/*! \brief Get the incoming potentials of the kept neurons at a given time
+	 *
+	 * Delivering many spikes with the same arrival time is cheaper through
+	 * this row than through receive(). The row starts at neuron getFirst().
+	 *
+	 * \param arrival	the time of arrival, seen from the simulation clock
+	 */
+	double* getIncomingRow(long arrival);
+
+
+	/*! \brief Advance all kept neurons by one step
+	 *
+	 *  Handles firing, potential updating, resetting of incoming buffers
+	 *  and clock incrementation.
+	 *
+	 *  \param current		external current applied to every neuron
+	 *
+	 *  \return The indices of the neurons that spiked during this step,
+	 *  		valid until the next call
+	 */
+	const std::vector<int>& update(double current);
+	
+	/*! \brief Advance a range of neurons by one step
+	 *
+	 *  Handles firing, potential updating and resetting of incoming buffers
+	 *  for the neurons in [\p first, \p last), without touching the clock.
+	 *  Disjoint ranges can be updated concurrently.
+	 *
+	 *  \param first		index of the first neuron to update, whose state is kept
+	 *  \param last			index after the last neuron to update, whose state is kept
+	 *  \param time			the step to simulate, seen from the simulation clock
+	 *  \param current		external current applied to every neuron
+	 *  \param spiked		output, receives the indices of the neurons that spiked
+	 *  \param noise		background noise of the kept neurons at this step, from neuron getFirst(),
+	 *  					generated beforehand, or nullptr to draw it here
+	 *
+	 *  \return The number of indices written to \p spiked
+	 */
+	int update(int first, int last, long time, double current, int* spiked, const double* noise = nullptr);
+	
+	/// Count a spike of neuron \p idx at step \p time, updated by another process
+	void recordSpike(int idx, long time);
+	
+	/// Increment the clock by \p steps, once all neurons were updated
+	void tick(int steps = 1);
+	
+	/*! \brief Write the state of all neurons to a checkpoint
+	 *
+	 * Clock, potentials, refractory steps, incoming potentials,
+	 * spike counts and, if it is kept, spike history
+	 */
+	void save(std::ostream& out) const;
+	
+	/// Read the state of all neurons from a checkpoint of a population of the same size and range
+	void load(std::istream& in);
+
+private:
+
+	int nNeurons;						//!< number of neurons
+	int firstNeuron, lastNeuron;		//!< neurons whose state is kept
+	int nExcitatory;					//!< number of excitatory neurons
+
+	double c1, c2;						//!< integration constants, shared by all neurons
+	double threshold;					//!< firing threshold
+	double reset;						//!< potential after a spike
+	int refractoryTime;					//!< inactive steps after a spike
+	double jExcitatory, jInhibitory;	//!< transmission values
+	bool hasNoise;						//!< true if there is external noise
+
+	long clock;							//!< population clock, initialised to 0
+
+	AlignedVector<double> potentials;	//!< membrane potentials of the kept neurons
+	AlignedVector<int> refractory;		//!< remaining refractory steps of the kept neurons, 0 if active
+
+	/// incoming potentials of the kept neurons, one slot more than the transmission delay
+	DelayRingBuffer incoming;
+	
+	BackgroundNoise noise;				//!< random input from the external neurons
+
+	bool hasHistory;					//!< true if the spike times are kept
+	std::vector<std::vector<long>> spikes;	//!< previous spikes of every neuron
+	std::vector<int> nSpikes;			//!< number of previous spikes of every neuron
+
+	std::vector<int> spiked;			//!< neurons which spiked during the last step
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include <cassert>
+#include <algorithm>
+#include "NoisePipeline.hpp"
+
+namespace {
+	/// Number of doubles in a cache line
+	constexpr long LINE = 64 / sizeof(double);
+}
+
+NoisePipeline::NoisePipeline(const BackgroundNoise& n, int size, int length)
+	: NoisePipeline(n, 0, size, length)
+{}
+
+NoisePipeline::NoisePipeline(const BackgroundNoise& n, int f, int l, int length)
+	: noise(n),
+	  first(f), last(l), epochLength(length),
+	  stride((l - f + LINE - 1) / LINE * LINE),
+	  requested(-1), requestedSteps(0), produced(-1),
+	  stopping(false)
+{
+	assert(epochLength > 0 && 0 <= first && first <= last);
+
+	for (auto& buffer : buffers) {
+		buffer.assign(epochLength * stride, 0.0);
+	}
+}
+
+NoisePipeline::~NoisePipeline() {
+	if (producer.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		condition.notify_all();
+		producer.join();
+	}
+}
+
+// get the maximum number of steps of an epoch
+int NoisePipeline::getEpochLength() const {
+	return epochLength;
+}
+
+// start the producer thread
+void NoisePipeline::startProducer() {
+	if (!producer.joinable()) {
+		producer = std::thread(&NoisePipeline::produce, this);
+	}
+}
+
+// get whether there is a producer thread
+bool NoisePipeline::hasProducer() const {
+	return producer.joinable();
+}
+
+// generate the noise of a range of neurons for a whole epoch
+void NoisePipeline::generate(int begin, int end, long epoch, int nSteps) {
+	// epochs never straddle two buffers
+	assert(0 < nSteps && epoch % epochLength + nSteps <= epochLength);
+	assert(first <= begin && begin <= end && end <= last);
+
+	for (long time = epoch; time < epoch + nSteps; ++time) {
+		double* row = buffers[(time / epochLength) % 2].data() + (time % epochLength) * stride;
+
+		std::fill(row + begin - first, row + end - first, 0.0);
+		noise.add(begin, end, time, row, first);
+	}
+}
+
+// hand an epoch to the producer thread
+void NoisePipeline::request(long epoch, int nSteps) {
+	assert(hasProducer());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		requested = epoch;
+		requestedSteps = nSteps;
+	}
+	condition.notify_all();
+}
+
+// wait for the producer thread
+void NoisePipeline::wait(long epoch) {
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [&]() { return produced == epoch; });
+}
+
+// generate requested epochs until the pipeline is destroyed
+void NoisePipeline::produce() {
+	long done = -1;
+
+	while (true) {
+		long epoch;
+		int nSteps;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&]() { return stopping || requested != done; });
+
+			if (stopping)
+				return;
+
+			epoch = requested;
+			nSteps = requestedSteps;
+		}
+
+		generate(first, last, epoch, nSteps);
+		done = epoch;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			produced = epoch;
+		}
+		condition.notify_all();
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef NOISE_PIPELINE_H
+#define NOISE_PIPELINE_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AlignedAllocator.hpp"
+#include "BackgroundNoise.hpp"
+
+/** \brief Background noise generated ahead, one epoch at a time
+ *
+ * Holds the noise of a range of neurons, e.g. those of one rank, for the steps
+ * of two consecutive epochs, one row per step, starting at the first neuron of the range. Epochs start on multiples of the epoch length and
+ * alternate between the two buffers, so the next epoch can be generated
+ * while the current one is simulated, either by the workers themselves
+ * or by a producer thread.
+ * */
+class NoisePipeline {
+
+public:
+	/*! \brief NoisePipeline constructor
+	 *
+	 * \param noise			the noise to generate, must outlive the pipeline
+	 * \param size			number of neurons
+	 * \param epochLength	maximum number of steps of an epoch
+	 */
+	NoisePipeline(const BackgroundNoise& noise, int size, int epochLength);
+
+	/*! \brief NoisePipeline constructor, for a range of neurons
+	 *
+	 * \param noise			the noise to generate, must outlive the pipeline
+	 * \param first			index of the first neuron
+	 * \param last			index after the last neuron
+	 * \param epochLength	maximum number of steps of an epoch
+	 */
+	NoisePipeline(const BackgroundNoise& noise, int first, int last, int epochLength);
+
+	/// NoisePipeline destructor, stops the producer thread
+	virtual ~NoisePipeline();
+
+	/// Get the maximum number of steps of an epoch
+	int getEpochLength() const;
+
+	/// Start a producer thread, in charge of generating all epochs requested afterwards
+	void startProducer();
+
+	/// Get whether a producer thread generates the epochs
+	bool hasProducer() const;
+
+
+	/*! \brief Generate the noise of a range of neurons for a whole epoch
+	 *
+	 * Disjoint ranges can be generated concurrently.
+	 *
+	 * \param first		index of the first neuron, in the range of the pipeline
+	 * \param last		index after the last neuron, in the range of the pipeline
+	 * \param epoch		first step of the epoch
+	 * \param nSteps	number of steps of the epoch
+	 */
+	void generate(int first, int last, long epoch, int nSteps);
+
+	/*! \brief Ask the producer thread for the noise of the whole range for a whole epoch
+	 *
+	 * The buffer of the epoch must not be in use anymore.
+	 *
+	 * \param epoch		first step of the epoch
+	 * \param nSteps	number of steps of the epoch
+	 */
+	void request(long epoch, int nSteps);
+
+	/// Block until the producer thread has generated the epoch starting at \p epoch
+	void wait(long epoch);
+
+
+	/// Get the noise of the range at step \p time, of an epoch generated beforehand, from its first neuron
+	const double* getRow(long time) const {
+		const AlignedVector<double>& buffer = buffers[(time / epochLength) % 2];
+		return buffer.data() + (time % epochLength) * stride;
+	}
+
+private:
+
+	/// Main loop of the producer thread
+	void produce();
+
+	const BackgroundNoise& noise;			//!< the generated noise
+
+	int first, last;						//!< range of neurons
+	int epochLength;						//!< maximum number of steps of an epoch
+	long stride;							//!< distance between two rows, in elements
+
+	AlignedVector<double> buffers[2];		//!< noise of two consecutive epochs
+
+	std::thread producer;					//!< the producer thread, if started
+
+	std::mutex mutex;
+	std::condition_variable condition;		//!< signals requests and generated epochs
+
+	long requested;							//!< first step of the last requested epoch
+	int requestedSteps;						//!< number of steps of the last requested epoch
+	long produced;							//!< first step of the last generated epoch
+	bool stopping;							//!< true when the pipeline is destroyed
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+	/// Names of the events, as written
+	const char* NAMES[] = { "cycles", "instructions", "llc_misses", "branch_misses" };
+}
+
+PerfCounters::PerfCounters()
+	: leader(-1), nOpen(0)
+{
+	descriptors.fill(-1);
+	slots.fill(-1);
+
+#ifdef __linux__
+	const uint64_t events[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+								PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+	// the first counter which opens leads the group, the others join it
+	for (int event = 0; event < N_EVENTS; ++event) {
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.config = events[event];
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const int descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+		if (descriptor < 0) {
+			if (error.empty()) {
+				error = std::string("cannot count ") + NAMES[event] + ": " + std::strerror(errno);
+			}
+			continue;
+		}
+
+		if (leader < 0) {
+			leader = descriptor;
+		}
+		descriptors[event] = descriptor;
+		slots[event] = nOpen++;
+	}
+#else
+	error = "hardware counters need Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+	// the members of the group before its leader
+	for (int descriptor : descriptors) {
+		if (descriptor >= 0 && descriptor != leader) {
+			close(descriptor);
+		}
+	}
+	if (leader >= 0) {
+		close(leader);
+	}
+}
+
+// get whether at least one counter counts
+bool PerfCounters::isOpen() const {
+	return leader >= 0;
+}
+
+// get whether an event is counted
+bool PerfCounters::has(Event event) const {
+	return slots[event] >= 0;
+}
+
+// get why a counter is missing
+const std::string& PerfCounters::getError() const {
+	return error;
+}
+
+// read the counts
+void PerfCounters::read(Values& values) const {
+	values.fill(0);
+	if (leader < 0)
+		return;
+
+	// number of counters, time enabled, time running, then the counts
+	uint64_t data[3 + N_EVENTS];
+	const ssize_t size = (3 + nOpen) * sizeof(uint64_t);
+	if (::read(leader, data, size) != size || data[0] != (uint64_t) nOpen)
+		return;
+
+	// the counters only ran part of the time if the kernel shared them with other groups
+	const double scale = data[2] > 0 && data[2] < data[1] ? data[1] / (double) data[2] : 1.0;
+
+	for (int event = 0; event < N_EVENTS; ++event) {
+		if (slots[event] >= 0) {
+			values[event] = scale == 1.0 ? data[3 + slots[event]] : (uint64_t) (data[3 + slots[event]] * scale);
+		}
+	}
+}
+
+// get the name of an event
+const char* PerfCounters::getName(Event event) {
+	return NAMES[event];
+}
@@ -0,0 +1,64 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <string>
+#include <cstdint>
+
+/** \brief Hardware performance counters of the calling thread
+ *
+ * Opens the Linux perf_event_open counters of the thread that creates it,
+ * in user space only, as one group read with a single system call.
+ * Counters the processor, the kernel or the container does not allow
+ * are left out: has() tells which ones count, and getError() why the others do not.
+ * Values are scaled up when the kernel multiplexes the counters.
+ * */
+class PerfCounters {
+
+public:
+	/// Hardware events
+	enum Event {
+		CYCLES,				//!< processor cycles
+		INSTRUCTIONS,		//!< retired instructions
+		CACHE_MISSES,		//!< last level cache misses
+		BRANCH_MISSES,		//!< mispredicted branches
+		N_EVENTS
+	};
+
+	/// Counts of every event, 0 for the missing ones
+	typedef std::array<uint64_t, N_EVENTS> Values;
+
+	/// PerfCounters constructor, opens the counters of the calling thread
+	PerfCounters();
+
+	/// PerfCounters destructor, closes the counters
+	virtual ~PerfCounters();
+
+	/// Not copyable, the counters belong to one thread
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/// Get whether at least one counter counts
+	bool isOpen() const;
+
+	/// Get whether event \p event is counted
+	bool has(Event event) const;
+
+	/// Get why the first missing counter could not be opened, empty if all count
+	const std::string& getError() const;
+
+	/// Read the counts since the counters were opened
+	void read(Values& values) const;
+
+	/// Get the name of an event
+	static const char* getName(Event event);
+
+private:
+	int leader;								//!< file descriptor of the group, -1 if no counter counts
+	std::array<int, N_EVENTS> descriptors;	//!< file descriptor of every counter, -1 if missing
+	std::array<int, N_EVENTS> slots;		//!< position of every counter in the group, -1 if missing
+	int nOpen;								//!< number of counters in the group
+	std::string error;						//!< why the first missing counter is missing
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstdint>
+
+/// Independent random streams, used as the last word of the Philox counter
+namespace Stream {
+	constexpr uint32_t NOISE = 0;			//!< background noise, counter (neuron, step)
+	constexpr uint32_t EXCITATORY = 1;		//!< excitatory sources, counter (neuron, block)
+	constexpr uint32_t INHIBITORY = 2;		//!< inhibitory sources, counter (neuron, block)
+}
+
+/** \brief Philox4x32-10 counter-based random number generator
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits, without any state
+ * (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC11).
+ * Every (key, counter) pair gives an independent draw, so random streams
+ * can be addressed directly, e.g. by neuron index and time step.
+ * */
+class Philox {
+
+public:
+	/// 128 bits of counter or output
+	struct Block {
+		uint32_t v[4];
+	};
+
+	/// Philox constructor, with a 64-bit key
+	explicit Philox(uint64_t seed)
+		: key0((uint32_t) seed), key1((uint32_t) (seed >> 32))
+	{}
+
+	/// Get the random block for a counter
+	Block operator()(Block counter) const {
+		uint32_t k0 = key0, k1 = key1;
+
+		for (int round = 0; round < 10; ++round) {
+			if (round > 0) {
+				k0 += 0x9E3779B9;
+				k1 += 0xBB67AE85;
+			}
+
+			uint64_t product0 = (uint64_t) 0xD2511F53 * counter.v[0];
+			uint64_t product1 = (uint64_t) 0xCD9E8D57 * counter.v[2];
+
+			counter = { {
+				(uint32_t) (product1 >> 32) ^ counter.v[1] ^ k0,
+				(uint32_t) product1,
+				(uint32_t) (product0 >> 32) ^ counter.v[3] ^ k1,
+				(uint32_t) product0
+			} };
+		}
+
+		return counter;
+	}
+
+	/// Get the random block for the counter (\p a, \p b, \p c, \p d)
+	Block operator()(uint32_t a, uint32_t b, uint32_t c, uint32_t d) const {
+		return (*this)(Block { { a, b, c, d } });
+	}
+
+	/// Convert two random words to a double uniformly distributed in [0, 1)
+	static double toUniform(uint32_t high, uint32_t low) {
+		uint64_t bits = ((uint64_t) high << 21) ^ (low >> 11);
+		return bits * (1.0 / 9007199254740992.0);
+	}
+
+private:
+
+	uint32_t key0, key1;		//!< the two halves of the key
+};
+
+#endif
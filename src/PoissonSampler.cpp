@@ -0,0 +1,79 @@
+#include <cmath>
+#include <cassert>
+#include "PoissonSampler.hpp"
+
+namespace {
+	/// 2^32, the number of values of a random word
+	constexpr double WORD_RANGE = 4294967296.0;
+
+	/// Upper bound on the result, guards against rounding in the tail inversion
+	constexpr int MAX_VALUE = 1000;
+}
+
+PoissonSampler::PoissonSampler(double l)
+	: lambda(l),
+	  guide(1 << GUIDE_BITS, 0)
+{
+	assert(lambda >= 0.0);
+
+	// tabulate the cumulative distribution until it rounds to 1 on 32 bits
+	double p = exp(-lambda);
+	double cdf = p;
+
+	for (int k = 0; ; ++k) {
+		uint64_t threshold = (uint64_t) std::llround(cdf * WORD_RANGE);
+
+		if (threshold >= (uint64_t) WORD_RANGE || k + 1 >= MAX_VALUE) {
+			// the last entry is above every word: draws reaching it belong to the tail
+			thresholds.push_back((uint64_t) WORD_RANGE);
+			tail = k;
+			break;
+		}
+
+		thresholds.push_back(threshold);
+		p *= lambda / (k + 1);
+		cdf += p;
+	}
+
+	// guide table: smallest result for every range of words
+	int k = 0;
+	for (int j = 0; j < (int) guide.size(); ++j) {
+		uint64_t lowest = (uint64_t) j << (32 - GUIDE_BITS);
+
+		while (lowest >= thresholds[k]) {
+			++k;
+		}
+
+		guide[j] = k;
+	}
+}
+
+// get the mean
+double PoissonSampler::getLambda() const {
+	return lambda;
+}
+
+// draw many numbers
+void PoissonSampler::sample(int n, const uint32_t* u, const uint32_t* extra, int* counts) const {
+	for (int i = 0; i < n; ++i) {
+		counts[i] = (*this)(u[i], extra[i]);
+	}
+}
+
+// continue the inversion in double precision beyond the table
+int PoissonSampler::sampleTail(uint32_t u, uint32_t extra) const {
+	// uniform draw in the tail, refined with the second word
+	double x = (u + (extra + 0.5) / WORD_RANGE) / WORD_RANGE;
+
+	double p = exp(-lambda);
+	double cdf = p;
+	int k = 0;
+
+	while (k < tail || (x >= cdf && k < MAX_VALUE)) {
+		++k;
+		p *= lambda / k;
+		cdf += p;
+	}
+
+	return k;
+}
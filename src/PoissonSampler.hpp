@@ -0,0 +1,66 @@
+#ifndef POISSON_SAMPLER_H
+#define POISSON_SAMPLER_H
+
+#include <vector>
+#include <cstdint>
+
+/** \brief Fast sampler of a Poisson distribution with a fixed mean
+ *
+ * Inverts the cumulative distribution, tabulated once on 32 bits:
+ * a guide table indexed by the top bits of a uniform word gives the
+ * result directly for almost all draws. The far tail, beyond the resolution
+ * of 32 bits, is inverted exactly with a second random word.
+ * */
+class PoissonSampler {
+
+public:
+	/// PoissonSampler constructor, for a mean of \p lambda
+	explicit PoissonSampler(double lambda);
+
+	/// Get the mean of the distribution
+	double getLambda() const;
+
+	/*! \brief Draw a number
+	 *
+	 * \param u			uniformly distributed random word
+	 * \param extra		second uniformly distributed random word, only used in the far tail
+	 */
+	int operator()(uint32_t u, uint32_t extra) const {
+		int k = guide[u >> (32 - GUIDE_BITS)];
+
+		while (u >= thresholds[k]) {
+			++k;
+		}
+
+		return k < tail ? k : sampleTail(u, extra);
+	}
+
+	/*! \brief Draw \p n numbers
+	 *
+	 * \param n			number of draws
+	 * \param u			uniformly distributed random words, one per draw
+	 * \param extra		second uniformly distributed random words, one per draw
+	 * \param counts	output, receives the numbers
+	 */
+	void sample(int n, const uint32_t* u, const uint32_t* extra, int* counts) const;
+
+private:
+
+	/// Number of bits indexing the guide table
+	static constexpr int GUIDE_BITS = 10;
+
+	/// Exact inversion, for a draw beyond the last tabulated value
+	int sampleTail(uint32_t u, uint32_t extra) const;
+
+	double lambda;						//!< mean of the distribution
+
+	/// thresholds[k]: the draw is k if u is below it and above thresholds[k - 1]
+	std::vector<uint64_t> thresholds;
+
+	/// guide[j]: smallest result for a draw whose top bits are j
+	std::vector<uint16_t> guide;
+
+	int tail;							//!< smallest result drawn by sampleTail()
+};
+
+#endif
@@ -0,0 +1,211 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "PopulationStatistics.hpp"
+#include "Checkpoint.hpp"
+
+PopulationStatistics::PopulationStatistics(int nE, int nI, int nThreads, long width, double step, long duration, int f, int l)
+	: nExcitatory(nE), nInhibitory(nI),
+	  binWidth(width),
+	  stepDuration(step),
+	  end(0),
+	  first(f), last(l < 0 ? nE + nI : l),
+	  neurons(last - first),
+	  lanes(nThreads)
+{
+	assert(nE >= 0 && nI >= 0 && nThreads > 0 && width > 0);
+	assert(0 <= first && first <= last && last <= nE + nI);
+
+	for (Lane& lane : lanes) {
+		lane.bins.reserve((duration + binWidth - 1) / binWidth);
+	}
+}
+
+// merge the counts of all threads
+void PopulationStatistics::finish(long e) {
+	end = e;
+	bins = merge();
+	bins.resize((end + binWidth - 1) / binWidth, Bin());
+}
+
+// write the counts and the statistics of every kept neuron
+void PopulationStatistics::save(std::ostream& out) const {
+	Checkpoint::writeArray(out, merge());
+	Checkpoint::writeArray(out, neurons);
+}
+
+// read the counts and the statistics of every kept neuron
+void PopulationStatistics::load(std::istream& in) {
+	// the first thread holds all counts so far
+	for (Lane& lane : lanes) {
+		lane.bins.clear();
+	}
+	Checkpoint::readArray(in, lanes[0].bins);
+	Checkpoint::readArray(in, neurons, neurons.size());
+}
+
+// get the number of steps of a bin
+long PopulationStatistics::getBinWidth() const {
+	return binWidth;
+}
+
+// get the number of bins
+std::size_t PopulationStatistics::getNbBins() const {
+	return bins.size();
+}
+
+// get the number of neurons of a population
+int PopulationStatistics::getNbNeurons(Population population) const {
+	switch (population) {
+		case EXCITATORY: return nExcitatory;
+		case INHIBITORY: return nInhibitory;
+		default: return nExcitatory + nInhibitory;
+	}
+}
+
+// get the number of spikes of a population
+long PopulationStatistics::getNbSpikes(Population population) const {
+	long n = 0;
+	for (const Bin& bin : bins) {
+		n += getCount(bin, population);
+	}
+	return n;
+}
+
+// get the mean firing rate of a population
+double PopulationStatistics::getRate(Population population) const {
+	if (end == 0 || getNbNeurons(population) == 0)
+		return 0.0;
+
+	return getNbSpikes(population) / (getNbNeurons(population) * end * stepDuration);
+}
+
+// get the firing rate of a population in every bin
+std::vector<double> PopulationStatistics::getRates(Population population) const {
+	std::vector<double> rates(bins.size(), 0.0);
+	if (getNbNeurons(population) == 0)
+		return rates;
+
+	for (std::size_t i = 0; i < bins.size(); ++i) {
+		rates[i] = getCount(bins[i], population) / (getNbNeurons(population) * getLength(i) * stepDuration);
+	}
+	return rates;
+}
+
+// get the variance of the number of spikes per bin
+double PopulationStatistics::getCountVariance(Population population) const {
+	if (bins.empty())
+		return 0.0;
+
+	const double mean = getNbSpikes(population) / (double) bins.size();
+	double variance = 0.0;
+	for (const Bin& bin : bins) {
+		const double deviation = getCount(bin, population) - mean;
+		variance += deviation * deviation;
+	}
+	return variance / bins.size();
+}
+
+// get the Fano factor of the number of spikes per bin
+double PopulationStatistics::getFanoFactor(Population population) const {
+	const double mean = bins.empty() ? 0.0 : getNbSpikes(population) / (double) bins.size();
+	return mean > 0.0 ? getCountVariance(population) / mean : 0.0;
+}
+
+// get the number of spikes of a neuron
+long PopulationStatistics::getNbSpikes(int neuron) const {
+	assert(first <= neuron && neuron < last);
+	return neurons[neuron - first].nSpikes;
+}
+
+// get the mean inter-spike interval of a neuron
+double PopulationStatistics::getIsiMean(int neuron) const {
+	assert(first <= neuron && neuron < last);
+	return neurons[neuron - first].mean;
+}
+
+// get the coefficient of variation of the intervals of a neuron
+double PopulationStatistics::getIsiCv(int neuron) const {
+	assert(first <= neuron && neuron < last);
+	const Neuron& stats = neurons[neuron - first];
+	const long nIntervals = stats.nSpikes - 1;
+
+	if (nIntervals < 2 || stats.mean <= 0.0)
+		return 0.0;
+
+	return std::sqrt(stats.m2 / nIntervals) / stats.mean;
+}
+
+// get the mean coefficient of variation of the intervals
+double PopulationStatistics::getIsiCv() const {
+	double sum = 0.0;
+	long n = 0;
+
+	for (int i = first; i < last; ++i) {
+		if (neurons[i - first].nSpikes > 2) {
+			sum += getIsiCv(i);
+			++n;
+		}
+	}
+	return n > 0 ? sum / n : 0.0;
+}
+
+// write all statistics
+void PopulationStatistics::write(std::ostream& out) const {
+	const double ms = stepDuration * 1E3;
+
+	out << "# population" << '\t' << "neurons" << '\t' << "spikes" << '\t' << "rate" << '\t' <<
+		"count_variance" << '\t' << "fano_factor" << '\n';
+
+	const char* names[] = { "all", "excitatory", "inhibitory" };
+	for (Population population : { ALL, EXCITATORY, INHIBITORY }) {
+		out << names[population] << '\t' << getNbNeurons(population) << '\t' << getNbSpikes(population) << '\t' <<
+			getRate(population) << '\t' << getCountVariance(population) << '\t' << getFanoFactor(population) << '\n';
+	}
+
+	out << "# isi_cv" << '\n' << getIsiCv() << '\n';
+
+	// population rates of every bin
+	const std::vector<double> all = getRates(ALL), excitatory = getRates(EXCITATORY), inhibitory = getRates(INHIBITORY);
+
+	out << "# time" << '\t' << "rate" << '\t' << "excitatory_rate" << '\t' << "inhibitory_rate" << '\n';
+	for (std::size_t i = 0; i < bins.size(); ++i) {
+		out << i * binWidth * ms << '\t' << all[i] << '\t' << excitatory[i] << '\t' << inhibitory[i] << '\n';
+	}
+
+	// intervals of every kept neuron
+	out << "# neuron" << '\t' << "spikes" << '\t' << "isi_mean" << '\t' << "isi_cv" << '\n';
+	for (int i = first; i < last; ++i) {
+		out << i << '\t' << neurons[i - first].nSpikes << '\t' << getIsiMean(i) * ms << '\t' << getIsiCv(i) << '\n';
+	}
+}
+
+// get the counts of all threads
+std::vector<PopulationStatistics::Bin> PopulationStatistics::merge() const {
+	std::vector<Bin> merged;
+
+	for (const Lane& lane : lanes) {
+		if (lane.bins.size() > merged.size()) {
+			merged.resize(lane.bins.size(), Bin());
+		}
+		for (std::size_t i = 0; i < lane.bins.size(); ++i) {
+			merged[i][0] += lane.bins[i][0];
+			merged[i][1] += lane.bins[i][1];
+		}
+	}
+	return merged;
+}
+
+// get the number of spikes of a population in a bin
+long PopulationStatistics::getCount(const Bin& bin, Population population) const {
+	switch (population) {
+		case EXCITATORY: return bin[0];
+		case INHIBITORY: return bin[1];
+		default: return bin[0] + bin[1];
+	}
+}
+
+// get the number of steps of a bin
+long PopulationStatistics::getLength(std::size_t bin) const {
+	return std::min(binWidth, end - (long) bin * binWidth);
+}
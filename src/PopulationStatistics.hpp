@@ -0,0 +1,159 @@
+#ifndef POPULATION_STATISTICS_H
+#define POPULATION_STATISTICS_H
+
+#include <vector>
+#include <array>
+#include <istream>
+#include <ostream>
+
+/** \brief Statistics of the spikes of a network, updated during the simulation
+ *
+ * Counts the spikes of the excitatory and inhibitory populations in bins of
+ * a few steps, for the population rate and the variance of the spike counts,
+ * and keeps the running mean and variance of the inter-spike intervals
+ * of every neuron (Welford's algorithm), so that no spike needs to be stored.
+ * The intervals can be kept for a range of neurons only, e.g. those of one rank.
+ *
+ * Threads must record the spikes of disjoint ranges of neurons, step after step:
+ * every thread counts in bins of its own, merged by finish().
+ * */
+class PopulationStatistics {
+
+public:
+	/// Neurons a statistic is computed over
+	enum Population { ALL, EXCITATORY, INHIBITORY };
+
+	/*! \brief PopulationStatistics constructor
+	 *
+	 * \param nExcitatory		number of excitatory neurons, the first ones
+	 * \param nInhibitory		number of inhibitory neurons
+	 * \param nThreads			number of threads recording spikes
+	 * \param binWidth			number of steps of a bin of the population rate
+	 * \param stepDuration		duration of one step, in s
+	 * \param duration			expected number of steps, to allocate the bins ahead
+	 * \param first				index of the first neuron whose intervals are kept
+	 * \param last				index after the last neuron whose intervals are kept, -1 for all neurons
+	 */
+	PopulationStatistics(int nExcitatory, int nInhibitory, int nThreads, long binWidth, double stepDuration, long duration = 0,
+						 int first = 0, int last = -1);
+
+	/// Default destructor
+	virtual ~PopulationStatistics() = default;
+
+	/// Record a spike of neuron \p neuron at step \p time, from thread \p thread
+	void record(int thread, long time, int neuron) {
+		if (first <= neuron && neuron < last) {
+			Neuron& stats = neurons[neuron - first];
+
+			// update the mean and the sum of squared deviations of the intervals
+			if (stats.nSpikes > 0) {
+				const double interval = time - stats.last;
+				const long n = stats.nSpikes;
+				const double delta = interval - stats.mean;
+
+				stats.mean += delta / n;
+				stats.m2 += delta * (interval - stats.mean);
+			}
+			stats.last = time;
+			++stats.nSpikes;
+		}
+
+		std::vector<Bin>& bins = lanes[thread].bins;
+		const std::size_t bin = time / binWidth;
+		if (bin >= bins.size()) {
+			bins.resize(bin + 1, Bin());
+		}
+		++bins[bin][neuron < nExcitatory ? 0 : 1];
+	}
+
+	/// Merge the counts of all threads, the simulation ended at step \p end
+	void finish(long end);
+
+	/// Write the counts of all threads and the statistics of every neuron to a checkpoint
+	void save(std::ostream& out) const;
+
+	/// Read the counts and statistics from a checkpoint of the same neurons and range, on any number of threads
+	void load(std::istream& in);
+
+	/// Get the number of steps of a bin
+	long getBinWidth() const;
+
+	/// Get the number of bins, the last one may be shorter
+	std::size_t getNbBins() const;
+
+	/// Get the number of neurons of a population
+	int getNbNeurons(Population population) const;
+
+	/// Get the number of spikes of a population
+	long getNbSpikes(Population population = ALL) const;
+
+	/// Get the mean firing rate of a population, in Hz
+	double getRate(Population population = ALL) const;
+
+	/// Get the firing rate of a population in every bin, in Hz
+	std::vector<double> getRates(Population population = ALL) const;
+
+	/// Get the variance of the number of spikes of a population per bin
+	double getCountVariance(Population population = ALL) const;
+
+	/// Get the Fano factor of the number of spikes of a population per bin
+	double getFanoFactor(Population population = ALL) const;
+
+	/// Get the number of spikes of a neuron whose intervals are kept
+	long getNbSpikes(int neuron) const;
+
+	/// Get the mean inter-spike interval of a neuron whose intervals are kept, in steps, 0 without intervals
+	double getIsiMean(int neuron) const;
+
+	/// Get the coefficient of variation of the inter-spike intervals of a neuron whose intervals are kept, 0 without two intervals
+	double getIsiCv(int neuron) const;
+
+	/// Get the mean coefficient of variation of the intervals of the kept neurons with at least two intervals
+	double getIsiCv() const;
+
+	/*! \brief Write all statistics
+	 *
+	 * Writes tab-separated tables, each one after a "# " header line: the summary of every population,
+	 * the population rates of every bin and the interval statistics of every kept neuron, times in ms.
+	 */
+	void write(std::ostream& out) const;
+
+private:
+
+	typedef std::array<long, 2> Bin;	//!< spikes of the excitatory and inhibitory neurons
+
+	/// Running statistics of one neuron
+	struct Neuron {
+		long last = 0;					//!< step of the last spike
+		long nSpikes = 0;				//!< number of spikes
+		double mean = 0.0;				//!< mean interval
+		double m2 = 0.0;				//!< sum of the squared deviations of the intervals from their mean
+	};
+
+	/// Counts of one recording thread
+	struct Lane {
+		std::vector<Bin> bins;			//!< spikes of every bin
+		char padding[64];				//!< keeps the lanes of different threads on different cache lines
+	};
+
+	/// Get the counts of all threads, merged
+	std::vector<Bin> merge() const;
+
+	/// Get the number of spikes of a population in a bin
+	long getCount(const Bin& bin, Population population) const;
+
+	/// Get the number of steps of a bin
+	long getLength(std::size_t bin) const;
+
+	int nExcitatory, nInhibitory;		//!< sizes of the populations
+	long binWidth;						//!< steps of a bin
+	double stepDuration;				//!< duration of one step, in s
+	long end;							//!< step at which the simulation ended
+
+	int first, last;					//!< neurons whose intervals are kept
+	std::vector<Neuron> neurons;		//!< statistics of every kept neuron
+	std::vector<Lane> lanes;			//!< counts of every thread
+	std::vector<Bin> bins;				//!< counts of all threads, merged by finish()
+};
+
+#endif
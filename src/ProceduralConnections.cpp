@@ -0,0 +1,53 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "ProceduralConnections.hpp"
+
+constexpr int ProceduralConnections::SEGMENT_SIZE;
+
+namespace {
+	/// Split the expected number of targets in a whole part and a probability in 1 / 2^32
+	void split(double expected, int& whole, uint32_t& fraction) {
+		whole = (int) std::floor(expected);
+		fraction = (uint32_t) std::min(4294967295.0, std::ldexp(expected - whole, 32));
+	}
+}
+
+ProceduralConnections::ProceduralConnections(int size, double epsilon, uint64_t s)
+	: nNeurons(size),
+	  nSegments((size + SEGMENT_SIZE - 1) / SEGMENT_SIZE),
+	  seed(mix(s))
+{
+	assert(size > 0 && 0.0 <= epsilon && epsilon <= 1.0);
+
+	split(epsilon * SEGMENT_SIZE, perSegment, fraction);
+	split(epsilon * (size - (nSegments - 1) * SEGMENT_SIZE), perLastSegment, lastFraction);
+}
+
+// get the number of neurons
+int ProceduralConnections::size() const {
+	return nNeurons;
+}
+
+// get the number of targets of a neuron
+int ProceduralConnections::getNbTargets(int source) const {
+	const uint64_t key = mix(seed ^ ((uint64_t) source << 32));
+
+	// only the first word of every segment, as in forEachTarget()
+	int n = 0;
+	for (int segment = 0; segment < nSegments; ++segment) {
+		const bool isLast = segment + 1 == nSegments;
+		uint64_t counter = mix(key + segment);
+
+		n += isLast ? perLastSegment : perSegment;
+		n += (uint32_t) next(counter) < (isLast ? lastFraction : fraction);
+	}
+	return n;
+}
+
+// get all targets of a neuron
+std::vector<int> ProceduralConnections::getTargets(int source) const {
+	std::vector<int> targets;
+	forEachTarget(source, 0, nNeurons, [&](int target) { targets.push_back(target); });
+	return targets;
+}
@@ -0,0 +1,108 @@
+#ifndef PROCEDURAL_CONNECTIONS_H
+#define PROCEDURAL_CONNECTIONS_H
+
+#include <vector>
+#include <cstdint>
+
+/** \brief Connectome regenerated on the fly instead of stored
+ *
+ * The targets of a neuron are a pure function of (seed, source), computed
+ * with an integer hash every time the neuron spikes, so the memory used does
+ * not depend on the number of synapses.
+ *
+ * Targets are drawn from the source's side: the neurons are split in segments
+ * of SEGMENT_SIZE neurons, and every source draws about epsilon times the size
+ * of every segment uniformly within it. Every source has the out-degree that
+ * the stored connectome has on average (epsilon times the number of neurons),
+ * while the in-degree of a neuron is only fixed on average, not exactly.
+ * Segments let a range of targets be regenerated without drawing all of them.
+ * */
+class ProceduralConnections {
+
+public:
+	/// Number of neurons in a segment
+	static constexpr int SEGMENT_SIZE = 1024;
+
+	/*! \brief ProceduralConnections constructor
+	 *
+	 * \param size			number of neurons
+	 * \param epsilon		connectivity
+	 * \param seed			seed of the connections
+	 */
+	ProceduralConnections(int size, double epsilon, uint64_t seed);
+
+	/// Get the number of neurons
+	int size() const;
+
+	/// Get the number of targets of neuron \p source, without drawing them
+	int getNbTargets(int source) const;
+
+	/// Get all targets of neuron \p source, in the order they are drawn
+	std::vector<int> getTargets(int source) const;
+
+	/*! \brief Regenerate the targets of a neuron within a range
+	 *
+	 * \param source	index of the neuron
+	 * \param first		index of the first target of the range
+	 * \param last		index after the last target of the range
+	 * \param function	called with every target in the range
+	 */
+	template<typename Function>
+	void forEachTarget(int source, int first, int last, Function function) const {
+		if (first >= last)
+			return;
+
+		const uint64_t key = mix(seed ^ ((uint64_t) source << 32));
+
+		for (int segment = first / SEGMENT_SIZE; segment * SEGMENT_SIZE < last; ++segment) {
+			const int begin = segment * SEGMENT_SIZE;
+			const uint64_t n = segment + 1 < nSegments ? SEGMENT_SIZE : nNeurons - begin;
+
+			// the fraction of a synapse is drawn with the first word
+			uint64_t counter = mix(key + segment);
+			int count = segment + 1 < nSegments ? perSegment : perLastSegment;
+			count += (uint32_t) next(counter) < (segment + 1 < nSegments ? fraction : lastFraction);
+
+			// two targets per word, multiply-shift maps 32 random bits to the segment
+			for (int i = 0; i < count; i += 2) {
+				const uint64_t bits = next(counter);
+
+				const int target0 = begin + (int) (((bits & 0xFFFFFFFF) * n) >> 32);
+				if (first <= target0 && target0 < last) {
+					function(target0);
+				}
+
+				const int target1 = begin + (int) (((bits >> 32) * n) >> 32);
+				if (i + 1 < count && first <= target1 && target1 < last) {
+					function(target1);
+				}
+			}
+		}
+	}
+
+private:
+
+	/// splitmix64 finalizer, a bijective integer hash
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+
+	/// Next word of the splitmix64 sequence starting at \p state
+	static uint64_t next(uint64_t& state) {
+		state += 0x9E3779B97F4A7C15;
+		return mix(state);
+	}
+
+	int nNeurons;				//!< number of neurons
+	int nSegments;				//!< number of segments, the last one may be smaller
+	uint64_t seed;				//!< hashed seed
+
+	int perSegment;				//!< whole number of targets in a full segment
+	uint32_t fraction;			//!< probability of one more target in a full segment, in 1 / 2^32
+	int perLastSegment;			//!< whole number of targets in the last segment
+	uint32_t lastFraction;		//!< probability of one more target in the last segment, in 1 / 2^32
+};
+
+#endif
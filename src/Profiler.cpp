@@ -0,0 +1,277 @@
+#include <cassert>
+#include "Profiler.hpp"
+
+constexpr bool Profiler::ENABLED;
+
+namespace {
+	/// Names of the phases and sections, as written
+	const char* PHASES[] = { "noise", "integrate", "record", "count", "exchange", "deliver", "wait" };
+	const char* SECTIONS[] = { "connections", "setup", "simulation", "checkpoint", "output" };
+
+	/// Get a duration in s
+	double seconds(Profiler::Clock::duration time) {
+		return std::chrono::duration<double>(time).count();
+	}
+
+	/// An epoch without time or counts
+	Profiler::Epoch empty() {
+		Profiler::Epoch epoch;
+		epoch.start = epoch.end = 0;
+		epoch.phases.fill(Profiler::Clock::duration::zero());
+		for (PerfCounters::Values& values : epoch.counts) {
+			values.fill(0);
+		}
+		epoch.nUpdates = epoch.nSpikes = epoch.nEvents = 0;
+		return epoch;
+	}
+
+	/// Add the times and counts of \p epoch to \p sum
+	void accumulate(Profiler::Epoch& sum, const Profiler::Epoch& epoch) {
+		for (int phase = 0; phase < Profiler::N_PHASES; ++phase) {
+			sum.phases[phase] += epoch.phases[phase];
+			for (int event = 0; event < PerfCounters::N_EVENTS; ++event) {
+				sum.counts[phase][event] += epoch.counts[phase][event];
+			}
+		}
+		sum.nUpdates += epoch.nUpdates;
+		sum.nSpikes += epoch.nSpikes;
+		sum.nEvents += epoch.nEvents;
+	}
+}
+
+Profiler::Profiler(int nThreads, bool timeline, bool counters, Tracer* t)
+	: hasTimeline(timeline), hasCounters(counters), tracer(t), lanes(nThreads)
+{
+	assert(nThreads > 0 && (tracer == nullptr || tracer->size() == 0));
+
+	for (int thread = 0; thread < nThreads; ++thread) {
+		lanes[thread].current = lanes[thread].total = empty();
+		lanes[thread].nSteps = 0;
+		lanes[thread].values.fill(0);
+
+		if (tracer != nullptr) {
+			tracer->addTrack("thread " + std::to_string(thread));
+		}
+	}
+	sections.fill(Clock::duration::zero());
+}
+
+// open the hardware counters of a thread
+void Profiler::open(int thread) {
+	lanes[thread].counters.reset(new PerfCounters());
+}
+
+// end an epoch of a thread
+void Profiler::endEpoch(int thread, long start, long end) {
+	Lane& lane = lanes[thread];
+	lane.current.start = start;
+	lane.current.end = end;
+	accumulate(lane.total, lane.current);
+	lane.nSteps += end - start;
+
+	if (hasTimeline) {
+		lane.epochs.push_back(lane.current);
+	}
+
+	if (tracer != nullptr) {
+		tracer->add(thread, "epoch", "epoch", lane.epochStart, lane.last, start, lane.current.nSpikes);
+	}
+	lane.epochStart = lane.last;
+	lane.current = empty();
+}
+
+// add a span to a section
+void Profiler::add(Section section, Clock::time_point begin, Clock::time_point end) {
+	sections[section] += end - begin;
+
+	if (tracer != nullptr) {
+		tracer->add(0, SECTIONS[section], "run", begin, end);
+	}
+}
+
+// get the number of threads
+int Profiler::size() const {
+	return lanes.size();
+}
+
+// get the name of a phase
+const char* Profiler::getName(Phase phase) {
+	return PHASES[phase];
+}
+
+// get the epochs of a thread
+const std::vector<Profiler::Epoch>& Profiler::getEpochs(int thread) const {
+	return lanes[thread].epochs;
+}
+
+// get the total time of a phase on a thread
+double Profiler::getTime(Phase phase, int thread) const {
+	return seconds(lanes[thread].total.phases[phase]);
+}
+
+// get the time of a section
+double Profiler::getTime(Section section) const {
+	return seconds(sections[section]);
+}
+
+// get the count of a hardware event in a phase
+uint64_t Profiler::getCount(Phase phase, PerfCounters::Event event) const {
+	uint64_t n = 0;
+	for (const Lane& lane : lanes) {
+		n += lane.total.counts[phase][event];
+	}
+	return n;
+}
+
+// get whether an event was counted on all threads
+bool Profiler::hasCount(PerfCounters::Event event) const {
+	if (!hasCounters)
+		return false;
+
+	for (const Lane& lane : lanes) {
+		if (lane.counters != nullptr && !lane.counters->has(event))
+			return false;
+	}
+	return true;
+}
+
+// get why hardware events are missing
+std::string Profiler::getCountersError() const {
+	for (const Lane& lane : lanes) {
+		if (lane.counters != nullptr && !lane.counters->getError().empty())
+			return lane.counters->getError();
+	}
+	return "";
+}
+
+// get the number of steps of all epochs
+long Profiler::getNbSteps() const {
+	return lanes[0].nSteps;
+}
+
+// get the number of neuron updates of all threads
+long Profiler::getNbUpdates() const {
+	long n = 0;
+	for (const Lane& lane : lanes) {
+		n += lane.total.nUpdates;
+	}
+	return n;
+}
+
+// get the number of spikes of all threads
+long Profiler::getNbSpikes() const {
+	long n = 0;
+	for (const Lane& lane : lanes) {
+		n += lane.total.nSpikes;
+	}
+	return n;
+}
+
+// get the number of synaptic events of all threads
+long Profiler::getNbEvents() const {
+	long n = 0;
+	for (const Lane& lane : lanes) {
+		n += lane.total.nEvents;
+	}
+	return n;
+}
+
+// write the profile
+void Profiler::write(std::ostream& out) const {
+	// time of every phase on every thread, and its share of all threads' time
+	double total = 0.0;
+	for (int thread = 0; thread < size(); ++thread) {
+		for (int phase = 0; phase < N_PHASES; ++phase) {
+			total += getTime((Phase) phase, thread);
+		}
+	}
+
+	out << "# phase";
+	for (int thread = 0; thread < size(); ++thread) {
+		out << '\t' << "thread_" << thread;
+	}
+	out << '\t' << "total" << '\t' << "share" << '\n';
+
+	for (int phase = 0; phase < N_PHASES; ++phase) {
+		double sum = 0.0;
+		out << PHASES[phase];
+		for (int thread = 0; thread < size(); ++thread) {
+			const double time = getTime((Phase) phase, thread);
+			out << '\t' << time;
+			sum += time;
+		}
+		out << '\t' << sum << '\t' << (total > 0.0 ? sum / total : 0.0) << '\n';
+	}
+
+	out << "# section" << '\t' << "time" << '\n';
+	for (int section = 0; section < N_SECTIONS; ++section) {
+		out << SECTIONS[section] << '\t' << getTime((Section) section) << '\n';
+	}
+
+	const long nSteps = getNbSteps();
+	out << "# steps" << '\t' << "spikes" << '\t' << "synaptic_events" << '\t' <<
+		"spikes_per_step" << '\t' << "events_per_step" << '\n';
+	out << nSteps << '\t' << getNbSpikes() << '\t' << getNbEvents() << '\t' <<
+		(nSteps > 0 ? getNbSpikes() / (double) nSteps : 0.0) << '\t' <<
+		(nSteps > 0 ? getNbEvents() / (double) nSteps : 0.0) << '\n';
+
+	// hardware events of every phase on all threads, and the ratios they give
+	if (hasCounters) {
+		const std::string error = getCountersError();
+		if (!error.empty()) {
+			out << "# missing hardware events: " << error << '\n';
+		}
+
+		out << "# phase_counters";
+		for (int event = 0; event < PerfCounters::N_EVENTS; ++event) {
+			out << '\t' << PerfCounters::getName((PerfCounters::Event) event);
+		}
+		out << '\t' << "ipc" << '\n';
+
+		for (int phase = 0; phase < N_PHASES; ++phase) {
+			out << PHASES[phase];
+			for (int event = 0; event < PerfCounters::N_EVENTS; ++event) {
+				out << '\t' << getCount((Phase) phase, (PerfCounters::Event) event);
+			}
+			const uint64_t cycles = getCount((Phase) phase, PerfCounters::CYCLES);
+			out << '\t' << (cycles > 0 ? getCount((Phase) phase, PerfCounters::INSTRUCTIONS) / (double) cycles : 0.0) << '\n';
+		}
+
+		// 0 for the events which were not counted
+		uint64_t cycles = 0, instructions = 0;
+		for (int phase = 0; phase < N_PHASES; ++phase) {
+			cycles += getCount((Phase) phase, PerfCounters::CYCLES);
+			instructions += getCount((Phase) phase, PerfCounters::INSTRUCTIONS);
+		}
+		const long nEvents = getNbEvents(), nUpdates = getNbUpdates();
+
+		out << "# ipc" << '\t' << "llc_misses_per_synaptic_event" << '\t' << "instructions_per_neuron_update" << '\n';
+		out << (cycles > 0 ? instructions / (double) cycles : 0.0) << '\t' <<
+			(nEvents > 0 ? getCount(DELIVER, PerfCounters::CACHE_MISSES) / (double) nEvents : 0.0) << '\t' <<
+			(nUpdates > 0 ? getCount(INTEGRATE, PerfCounters::INSTRUCTIONS) / (double) nUpdates : 0.0) << '\n';
+	}
+
+	if (!hasTimeline)
+		return;
+
+	// phases of every epoch of every thread
+	out << "# start" << '\t' << "end" << '\t' << "thread";
+	for (const char* phase : PHASES) {
+		out << '\t' << phase;
+	}
+	out << '\t' << "spikes" << '\t' << "synaptic_events" << '\n';
+
+	for (std::size_t k = 0; k < lanes[0].epochs.size(); ++k) {
+		for (int thread = 0; thread < size(); ++thread) {
+			if (k >= lanes[thread].epochs.size())
+				continue;
+
+			const Epoch& epoch = lanes[thread].epochs[k];
+			out << epoch.start << '\t' << epoch.end << '\t' << thread;
+			for (const Clock::duration& time : epoch.phases) {
+				out << '\t' << seconds(time);
+			}
+			out << '\t' << epoch.nSpikes << '\t' << epoch.nEvents << '\n';
+		}
+	}
+}
@@ -0,0 +1,203 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <ostream>
+#include "PerfCounters.hpp"
+#include "Tracer.hpp"
+
+/** \brief Time spent by the simulation threads in every phase of an epoch
+ *
+ * Every thread marks the end of each phase with lap(), which charges the time
+ * since its previous mark to that phase, so that one clock read separates two phases.
+ * Every thread adds up the times, spikes and synaptic events of its epochs as they end,
+ * for the summary; the epochs themselves are only kept for the timeline.
+ *
+ * With hardware counters, every thread also reads its PerfCounters at every mark,
+ * to give every phase its cycles, instructions, cache and branch misses.
+ * Without them, e.g. in a container, the profile only has the times.
+ *
+ * With a Tracer, every phase, epoch and section is also added to the track
+ * of its thread, for a timeline of the threads.
+ *
+ * The network only calls the profiler in a build with the PROFILING option
+ * (-DPROFILING=ON), see ENABLED: otherwise the calls are compiled out.
+ * */
+class Profiler {
+
+public:
+#ifdef PROFILING
+	static constexpr bool ENABLED = true;		//!< the network is built with its profiler
+#else
+	static constexpr bool ENABLED = false;		//!< the network is built with its profiler
+#endif
+
+	typedef std::chrono::steady_clock Clock;
+
+	/// Phases of an epoch on a simulation thread
+	enum Phase {
+		NOISE,			//!< generating the background noise
+		INTEGRATE,		//!< updating the neurons
+		RECORD,			//!< handing the spikes to the statistics and the recorder
+		COUNT,			//!< counting the synaptic events for the profile
+		EXCHANGE,		//!< exchanging the spikes with the other ranks
+		DELIVER,		//!< delivering the spikes to their targets
+		WAIT,			//!< waiting for the other threads or the noise producer
+		N_PHASES
+	};
+
+	/// Parts of a run, on the calling thread
+	enum Section {
+		CONNECTIONS,	//!< drawing, or mapping, the connections in the network constructor
+		SETUP,			//!< the rest of the network constructor
+		SIMULATION,		//!< all epochs
+		CHECKPOINT,		//!< writing checkpoints
+		OUTPUT,			//!< completing the result file
+		N_SECTIONS
+	};
+
+	/// Times and counts of one epoch of one thread
+	struct Epoch {
+		long start, end;								//!< steps of the epoch, [start, end)
+		std::array<Clock::duration, N_PHASES> phases;	//!< time spent in every phase
+		std::array<PerfCounters::Values, N_PHASES> counts;	//!< hardware events of every phase
+		long nUpdates;									//!< neuron updates of the thread
+		long nSpikes;									//!< spikes of the thread's neurons
+		long nEvents;									//!< synaptic events of these spikes
+	};
+
+	/*! \brief Profiler constructor
+	 *
+	 * \param nThreads		number of simulation threads
+	 * \param timeline		keep every epoch of every thread, for the timeline
+	 * \param counters		read the hardware counters of every phase, if they are available
+	 * \param tracer		receives the events of every thread, on its first tracks, nullptr for none;
+	 * 						must outlive the profiler
+	 */
+	explicit Profiler(int nThreads, bool timeline = false, bool counters = false, Tracer* tracer = nullptr);
+
+	/// Default destructor
+	virtual ~Profiler() = default;
+
+	/// Start the clock of thread \p thread, before its first phase, on that thread
+	void start(int thread) {
+		Lane& lane = lanes[thread];
+		if (hasCounters && lane.counters == nullptr) {
+			open(thread);
+		}
+		if (lane.counters != nullptr) {
+			lane.counters->read(lane.values);
+		}
+		lane.last = lane.epochStart = Clock::now();
+	}
+
+	/// End phase \p phase of thread \p thread: the time since the previous mark is charged to it
+	void lap(int thread, Phase phase) {
+		Lane& lane = lanes[thread];
+		const Clock::time_point now = Clock::now();
+		lane.current.phases[phase] += now - lane.last;
+		if (tracer != nullptr) {
+			tracer->add(thread, getName(phase), "phase", lane.last, now);
+		}
+		lane.last = now;
+
+		if (lane.counters != nullptr) {
+			PerfCounters::Values values;
+			lane.counters->read(values);
+			for (int event = 0; event < PerfCounters::N_EVENTS; ++event) {
+				lane.current.counts[phase][event] += values[event] - lane.values[event];
+			}
+			lane.values = values;
+		}
+	}
+
+	/// Count neuron updates, spikes and synaptic events of the epoch of thread \p thread
+	void count(int thread, long nUpdates, long nSpikes, long nEvents) {
+		lanes[thread].current.nUpdates += nUpdates;
+		lanes[thread].current.nSpikes += nSpikes;
+		lanes[thread].current.nEvents += nEvents;
+	}
+
+	/// End the epoch [start, end) of thread \p thread
+	void endEpoch(int thread, long start, long end);
+
+	/// Add the span [\p begin, \p end) to a section of the run, on thread 0
+	void add(Section section, Clock::time_point begin, Clock::time_point end);
+
+	/// Get the number of threads
+	int size() const;
+
+	/// Get the name of a phase
+	static const char* getName(Phase phase);
+
+	/// Get the epochs of a thread, in order, empty without the timeline
+	const std::vector<Epoch>& getEpochs(int thread) const;
+
+	/// Get the total time of a phase on a thread, in s
+	double getTime(Phase phase, int thread) const;
+
+	/// Get the time of a section, in s
+	double getTime(Section section) const;
+
+	/// Get the count of a hardware event in a phase, on all threads
+	uint64_t getCount(Phase phase, PerfCounters::Event event) const;
+
+	/// Get whether event \p event was counted on all threads
+	bool hasCount(PerfCounters::Event event) const;
+
+	/// Get why hardware events are missing, empty if they were not asked for or all were counted
+	std::string getCountersError() const;
+
+	/// Get the number of steps of all epochs
+	long getNbSteps() const;
+
+	/// Get the number of neuron updates of all threads
+	long getNbUpdates() const;
+
+	/// Get the number of spikes of all threads
+	long getNbSpikes() const;
+
+	/// Get the number of synaptic events of all threads
+	long getNbEvents() const;
+
+	/*! \brief Write the profile
+	 *
+	 * Writes tab-separated tables, each one after a "# " header line: the time of every phase
+	 * on every thread and its share of the simulation, the sections of the run, the spikes
+	 * and synaptic events per step, the hardware events of every phase on all threads
+	 * with the instructions per cycle, the last level cache misses per synaptic event
+	 * and the instructions per neuron update, and, with the timeline,
+	 * the phases of every epoch of every thread. Times are in s.
+	 */
+	void write(std::ostream& out) const;
+
+private:
+
+	/// Open the hardware counters of thread \p thread, on that thread
+	void open(int thread);
+
+	/// Measures of one thread
+	struct Lane {
+		Clock::time_point last;			//!< end of the previous phase
+		Clock::time_point epochStart;	//!< start of the epoch in progress
+		std::unique_ptr<PerfCounters> counters;	//!< hardware counters of the thread, if open
+		PerfCounters::Values values;	//!< counts at the end of the previous phase
+		Epoch current;					//!< the epoch in progress
+		Epoch total;					//!< sums of the finished epochs
+		long nSteps;					//!< steps of the finished epochs
+		std::vector<Epoch> epochs;		//!< the finished epochs, with the timeline
+		char padding[64];				//!< keeps the lanes of different threads on different cache lines
+	};
+
+	bool hasTimeline;										//!< every epoch is kept
+	bool hasCounters;										//!< the hardware counters are read
+	Tracer* tracer;											//!< receives the events, nullptr for none
+	std::vector<Lane> lanes;								//!< measures of every thread
+	std::array<Clock::duration, N_SECTIONS> sections;		//!< time of every section
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SpikeReader.hpp"
+
+SpikeReader::SpikeReader(const std::string& filename) {
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("cannot open spike file '" + filename + "'");
+
+	struct stat status;
+	void* address = MAP_FAILED;
+	std::size_t size = 0;
+
+	if (fstat(file, &status) == 0 && (std::size_t) status.st_size >= sizeof(SpikeFormat::Header) + sizeof(SpikeFormat::Trailer)) {
+		size = status.st_size;
+		address = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	}
+
+	// the mapping stays valid without the file descriptor
+	close(file);
+
+	if (address == MAP_FAILED)
+		throw std::runtime_error("cannot map spike file '" + filename + "'");
+
+	mapping = std::shared_ptr<void>(address, [size](void* p) { munmap(p, size); });
+	data = (const char*) address;
+	header = (const SpikeFormat::Header*) data;
+	trailer = (const SpikeFormat::Trailer*) (data + size - sizeof(SpikeFormat::Trailer));
+
+	// check the header and the trailer before trusting the data
+	if (std::memcmp(header->magic, SpikeFormat::MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != SpikeFormat::VERSION || header->byteOrder != SpikeFormat::ENDIANNESS)
+		throw std::runtime_error("'" + filename + "' is not a spike file of this version and architecture");
+
+	if (std::memcmp(trailer->magic, SpikeFormat::END, sizeof(trailer->magic)) != 0 ||
+		trailer->footer < sizeof(SpikeFormat::Header) || trailer->nChunks > size / sizeof(SpikeFormat::Entry) ||
+		trailer->footer + trailer->nChunks * sizeof(SpikeFormat::Entry) + sizeof(SpikeFormat::Trailer) != size)
+		throw std::runtime_error("spike file '" + filename + "' is incomplete");
+
+	entries = (const SpikeFormat::Entry*) (data + trailer->footer);
+
+	// every chunk lies between the header and the footer, in order of window
+	for (uint64_t i = 0; i < trailer->nChunks; ++i) {
+		const SpikeFormat::Entry& entry = entries[i];
+		if (entry.offset < sizeof(SpikeFormat::Header) || entry.offset > trailer->footer ||
+			entry.nSpikes > (trailer->footer - entry.offset) / sizeof(uint32_t) ||
+			(i > 0 && entry.window < entries[i - 1].window))
+			throw std::runtime_error("spike file '" + filename + "' has an invalid index");
+	}
+}
+
+// get the number of neurons
+int SpikeReader::getNbNeurons() const {
+	return header->nNeurons;
+}
+
+// get the end of the simulation
+long SpikeReader::getEnd() const {
+	return trailer->end;
+}
+
+// get the number of spikes
+std::size_t SpikeReader::getNbSpikes() const {
+	std::size_t n = 0;
+	for (uint64_t i = 0; i < trailer->nChunks; ++i) {
+		n += entries[i].nSpikes;
+	}
+	return n;
+}
+
+// read a slice of the spikes
+std::vector<Spike> SpikeReader::read(long firstTime, long lastTime, int firstNeuron, int lastNeuron) const {
+	std::vector<Spike> spikes;
+
+	// skip to the first window of the slice
+	const long firstWindow = firstTime - ((firstTime % header->windowLength) + header->windowLength) % header->windowLength;
+	const SpikeFormat::Entry* end = entries + trailer->nChunks;
+	const SpikeFormat::Entry* entry = std::lower_bound(entries, end, firstWindow,
+		[](const SpikeFormat::Entry& e, long window) { return e.window < window; });
+
+	std::vector<Spike> window;
+	for (; entry != end && entry->window < lastTime; ) {
+		// the chunks of one window, each one sorted by time
+		window.clear();
+		const int64_t start = entry->window;
+
+		for (; entry != end && entry->window == start; ++entry) {
+			if ((long) entry->block >= lastNeuron || (long) (entry->block + header->blockSize) <= firstNeuron)
+				continue;
+
+			const uint32_t* records = (const uint32_t*) (data + entry->offset);
+			for (uint64_t i = 0; i < entry->nSpikes; ++i) {
+				const long time = start + (records[i] & 0xFFFF);
+				const int neuron = entry->block + (records[i] >> 16);
+
+				if (firstTime <= time && time < lastTime && firstNeuron <= neuron && neuron < lastNeuron) {
+					window.push_back({ time, neuron });
+				}
+			}
+		}
+
+		// merge the blocks in order of time
+		std::stable_sort(window.begin(), window.end(), [](const Spike& a, const Spike& b) { return a.time < b.time; });
+		spikes.insert(spikes.end(), window.begin(), window.end());
+	}
+
+	return spikes;
+}
+
+// read all spikes
+std::vector<Spike> SpikeReader::read() const {
+	return read(0, getEnd(), 0, getNbNeurons());
+}
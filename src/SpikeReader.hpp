@@ -0,0 +1,55 @@
+#ifndef SPIKE_READER_H
+#define SPIKE_READER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include "SpikeWriter.hpp"
+
+/** \brief Reads the spikes of a binary spike file
+ *
+ * Maps the file written by BinarySpikeWriter in memory, and decodes
+ * only the chunks overlapping the requested slice of times and neurons.
+ * Errors raise std::runtime_error.
+ * */
+class SpikeReader {
+
+public:
+	/// SpikeReader constructor, maps the file
+	explicit SpikeReader(const std::string& filename);
+
+	/// Default destructor, unmaps the file
+	virtual ~SpikeReader() = default;
+
+	/// Get the number of neurons of the simulation
+	int getNbNeurons() const;
+
+	/// Get the step at which the simulation ended
+	long getEnd() const;
+
+	/// Get the number of spikes of the file
+	std::size_t getNbSpikes() const;
+
+	/*! \brief Read a slice of the spikes
+	 *
+	 * \param firstTime		first step of the slice
+	 * \param lastTime		step after the last step of the slice
+	 * \param firstNeuron	first neuron of the slice
+	 * \param lastNeuron	neuron after the last neuron of the slice
+	 * \return the spikes of the slice, in order of time, then neuron
+	 */
+	std::vector<Spike> read(long firstTime, long lastTime, int firstNeuron, int lastNeuron) const;
+
+	/// Read all spikes
+	std::vector<Spike> read() const;
+
+private:
+
+	std::shared_ptr<void> mapping;				//!< the mapped file
+	const char* data;							//!< start of the file
+	const SpikeFormat::Header* header;			//!< the header
+	const SpikeFormat::Trailer* trailer;		//!< the trailer
+	const SpikeFormat::Entry* entries;			//!< the index of the chunks, by window then block
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include "SpikeRecorder.hpp"
+
+namespace {
+	/// Number of spikes passed to the output at once
+	constexpr std::size_t BATCH_SIZE = 1 << 16;
+}
+
+SpikeRecorder::SpikeRecorder(std::unique_ptr<SpikeWriter> o, int nThreads, int size, int nChunks)
+	: chunkSize(size),
+	  output(std::move(o)),
+	  pending(false), stopping(false)
+{
+	assert(nThreads > 0 && size > 0 && nChunks >= 3);
+
+	for (int i = 0; i < nThreads; ++i) {
+		lanes.emplace_back(new Lane(nChunks));
+		Lane& lane = *lanes.back();
+
+		// the first chunk is filled, the others are free
+		lane.chunks.resize(nChunks);
+		for (Chunk& chunk : lane.chunks) {
+			chunk.reserve(chunkSize);
+		}
+
+		lane.current = &lane.chunks[0];
+		for (int k = 1; k < nChunks; ++k) {
+			lane.free.push(&lane.chunks[k]);
+		}
+	}
+
+	writer = std::thread(&SpikeRecorder::write, this);
+}
+
+SpikeRecorder::~SpikeRecorder() {
+	finish();
+}
+
+// get whether the file could be opened
+bool SpikeRecorder::isOpen() const {
+	return output->isOpen();
+}
+
+// all spikes of a thread before a step were recorded
+void SpikeRecorder::advance(int thread, long time) {
+	Lane& lane = *lanes[thread];
+
+	if (!lane.current->empty()) {
+		hand(lane, time);
+	} else {
+		lane.complete.store(time, std::memory_order_release);
+		notify();
+	}
+}
+
+// write the remaining spikes and stop the writer
+void SpikeRecorder::finish() {
+	if (writer.joinable()) {
+		stopping.store(true, std::memory_order_release);
+		notify();
+		writer.join();
+	}
+}
+
+// hand the current chunk to the writer
+void SpikeRecorder::hand(Lane& lane, long time) {
+	// never full: the queue holds all chunks of the thread
+	lane.full.push(lane.current);
+	lane.complete.store(time, std::memory_order_release);
+	notify();
+
+	// wait for the writer to give a chunk back
+	while (!lane.free.pop(lane.current)) {
+		notify();
+		std::this_thread::yield();
+	}
+}
+
+// wake the writer up
+void SpikeRecorder::notify() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending = true;
+	}
+	condition.notify_one();
+}
+
+// merge and write the chunks of all threads until the recorder finishes
+void SpikeRecorder::write() {
+	std::vector<Spike> batch;
+	batch.reserve(BATCH_SIZE);
+	long written = 0;
+
+	while (true) {
+		// the spikes are complete when stopping is seen before reading the progress
+		const bool isLast = stopping.load(std::memory_order_acquire);
+
+		long complete = std::numeric_limits<long>::max();
+		for (const auto& lane : lanes) {
+			complete = std::min(complete, lane->complete.load(std::memory_order_acquire));
+		}
+
+		// the spikes of every step, by thread, i.e. by increasing neuron
+		for (long time = written; time < complete; ++time) {
+			for (const auto& pointer : lanes) {
+				Lane& lane = *pointer;
+
+				while (true) {
+					// next chunk, giving the written one back
+					if (lane.reading == nullptr || lane.position == lane.reading->size()) {
+						if (lane.reading != nullptr) {
+							lane.reading->clear();
+							lane.free.push(lane.reading);
+							lane.reading = nullptr;
+						}
+						if (!lane.full.pop(lane.reading))
+							break;
+						lane.position = 0;
+					}
+
+					const Spike& spike = (*lane.reading)[lane.position];
+					assert(spike.time >= time);
+					if (spike.time != time)
+						break;
+
+					batch.push_back(spike);
+					++lane.position;
+				}
+			}
+
+			if (batch.size() >= BATCH_SIZE) {
+				output->write(batch.data(), batch.size());
+				batch.clear();
+			}
+		}
+		written = std::max(written, complete);
+
+		// the spikes reach the output as soon as they are complete
+		output->write(batch.data(), batch.size());
+		batch.clear();
+
+		if (isLast) {
+			output->close(written);
+			return;
+		}
+
+		// sleep until a chunk is handed over
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait_for(lock, std::chrono::milliseconds(10), [&]() { return pending; });
+		pending = false;
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef SPIKE_RECORDER_H
+#define SPIKE_RECORDER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "SpscQueue.hpp"
+#include "SpikeWriter.hpp"
+
+/** \brief Writes the spikes to a file while the simulation runs
+ *
+ * Every simulation thread appends its spikes to chunks of its own, and hands
+ * full chunks to a writer thread through a lock-free queue. The writer merges
+ * the chunks of all threads in (time, neuron) order and passes them to a SpikeWriter,
+ * then gives the chunks back: the memory used does not grow with the length of the simulation,
+ * and a simulation thread only waits if the writer falls behind by all its chunks.
+ *
+ * Threads must record the spikes of disjoint, increasing ranges of neurons,
+ * step after step, so the file does not depend on the number of threads.
+ * */
+class SpikeRecorder {
+
+public:
+	/*! \brief SpikeRecorder constructor, starts the writer thread
+	 *
+	 * \param output		receives the spikes, in order
+	 * \param nThreads		number of threads recording spikes
+	 * \param chunkSize		number of spikes of a chunk, at least the number of neurons of a thread
+	 * \param nChunks		number of chunks of every thread, at least 3
+	 */
+	SpikeRecorder(std::unique_ptr<SpikeWriter> output, int nThreads, int chunkSize, int nChunks = 8);
+
+	/// SpikeRecorder destructor, writes the remaining spikes
+	virtual ~SpikeRecorder();
+
+	/// Get whether the output file could be opened
+	bool isOpen() const;
+
+	/// Record a spike of neuron \p neuron at step \p time, from thread \p thread
+	void record(int thread, long time, int neuron) {
+		Lane& lane = *lanes[thread];
+		if (lane.current->size() == chunkSize) {
+			hand(lane, time);
+		}
+		lane.current->push_back({ time, neuron });
+	}
+
+	/*! \brief Declare that thread \p thread recorded all its spikes before step \p time
+	 *
+	 * Hands the current chunk to the writer, so that the spikes of other threads
+	 * are not held back.
+	 */
+	void advance(int thread, long time);
+
+	/// Write all spikes recorded before step \p time and stop the writer, once all threads advanced
+	void finish();
+
+private:
+
+	typedef std::vector<Spike> Chunk;
+
+	/// Chunks and progress of one recording thread
+	struct Lane {
+		explicit Lane(int nChunks) : full(nChunks), free(nChunks), complete(0), position(0) {}
+
+		std::vector<Chunk> chunks;			//!< all chunks of the thread
+		Chunk* current;						//!< chunk being filled by the thread
+
+		SpscQueue<Chunk*> full;				//!< chunks handed to the writer
+		SpscQueue<Chunk*> free;				//!< chunks given back by the writer
+		std::atomic<long> complete;			//!< all spikes before this step were handed
+
+		Chunk* reading = nullptr;			//!< chunk being written, used by the writer only
+		std::size_t position;				//!< next spike of the chunk being written
+	};
+
+	/// Hand the current chunk to the writer, \p time is the first step it may miss
+	void hand(Lane& lane, long time);
+
+	/// Wake the writer up
+	void notify();
+
+	/// Main loop of the writer thread
+	void write();
+
+	std::size_t chunkSize;						//!< number of spikes of a chunk
+	std::vector<std::unique_ptr<Lane>> lanes;	//!< one per recording thread
+
+	std::unique_ptr<SpikeWriter> output;		//!< receives the merged spikes
+	std::thread writer;							//!< the writer thread
+
+	std::mutex mutex;
+	std::condition_variable condition;			//!< wakes the writer up
+	bool pending;								//!< true if the writer has work
+	std::atomic<bool> stopping;					//!< true once all spikes were recorded
+};
+
+#endif
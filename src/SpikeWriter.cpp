@@ -0,0 +1,258 @@
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <unistd.h>
+#include "SpikeWriter.hpp"
+
+constexpr std::size_t TextSpikeWriter::MAX_LINE;
+constexpr int BinarySpikeWriter::WINDOW_LENGTH;
+constexpr int BinarySpikeWriter::BLOCK_SIZE;
+
+namespace {
+	/// Size of the text written at once
+	constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+	/// Number of spikes from which a batch is formatted by several threads
+	constexpr std::size_t PARALLEL_BATCH = 1 << 15;
+
+	/// All numbers of two digits
+	const char DIGITS[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	/// Format a non-negative integer, return the end of the written digits
+	inline char* formatInteger(char* out, uint64_t value) {
+		char digits[20];
+		char* first = digits + sizeof(digits);
+
+		// two digits at a time, from the last ones
+		while (value >= 100) {
+			first -= 2;
+			std::memcpy(first, DIGITS + (value % 100) * 2, 2);
+			value /= 100;
+		}
+
+		if (value >= 10) {
+			first -= 2;
+			std::memcpy(first, DIGITS + value * 2, 2);
+		} else {
+			*--first = '0' + value;
+		}
+
+		const std::size_t length = digits + sizeof(digits) - first;
+		std::memcpy(out, first, length);
+		return out + length;
+	}
+
+	static_assert(sizeof(SpikeFormat::Header) == 64, "the header is one cache line");
+	static_assert(BinarySpikeWriter::WINDOW_LENGTH <= 1 << 16, "steps are relative to their window in 16 bits");
+	static_assert(BinarySpikeWriter::BLOCK_SIZE <= 1 << 16, "neurons are relative to their block in 16 bits");
+}
+
+// open a writer for a file
+std::unique_ptr<SpikeWriter> SpikeWriter::open(const std::string& filename, const std::string& format, int nNeurons,
+											   int nThreads, bool append) {
+	if (format == "gdf")
+		return std::unique_ptr<SpikeWriter>(new TextSpikeWriter(filename, nThreads, append));
+	if (format == "binary")
+		return std::unique_ptr<SpikeWriter>(new BinarySpikeWriter(filename, nNeurons, append));
+
+	throw std::invalid_argument("unknown spike format '" + format + "'");
+}
+
+
+TextSpikeWriter::TextSpikeWriter(const std::string& filename, int nThreads, bool append)
+	: file(filename, append ? std::ios::binary | std::ios::app : std::ios::binary),
+	  buffer(BUFFER_SIZE), used(0),
+	  pool(nThreads > 1 ? new ThreadPool(nThreads) : nullptr),
+	  parts(nThreads)
+{}
+
+// get whether the file could be opened
+bool TextSpikeWriter::isOpen() const {
+	return file.is_open();
+}
+
+// write spikes as text lines
+void TextSpikeWriter::write(const Spike* spikes, std::size_t n) {
+	// large batches: every thread formats a part, written in order
+	if (pool != nullptr && n >= PARALLEL_BATCH) {
+		drain();
+
+		std::vector<std::size_t> lengths(parts.size());
+		pool->run([&](int thread) {
+			const std::size_t first = n * thread / parts.size(), last = n * (thread + 1) / parts.size();
+
+			std::vector<char>& part = parts[thread];
+			part.resize((last - first) * MAX_LINE);
+			lengths[thread] = format(part.data(), spikes + first, last - first) - part.data();
+		});
+
+		for (std::size_t i = 0; i < parts.size(); ++i) {
+			file.write(parts[i].data(), lengths[i]);
+		}
+		return;
+	}
+
+	for (std::size_t i = 0; i < n; ) {
+		// as many spikes as the buffer surely holds
+		const std::size_t count = std::min(n - i, (buffer.size() - used) / MAX_LINE);
+		used = format(buffer.data() + used, spikes + i, count) - buffer.data();
+		i += count;
+
+		if (buffer.size() - used < MAX_LINE) {
+			drain();
+		}
+	}
+}
+
+// write the remaining text
+void TextSpikeWriter::close(long) {
+	drain();
+	file.close();
+}
+
+// format one line per spike
+char* TextSpikeWriter::format(char* out, const Spike* spikes, std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		out = formatInteger(out, spikes[i].time);
+		*out++ = '\t';
+		out = formatInteger(out, spikes[i].neuron);
+		*out++ = '\n';
+	}
+	return out;
+}
+
+// write the buffer to the file
+void TextSpikeWriter::drain() {
+	file.write(buffer.data(), used);
+	file.flush();
+	used = 0;
+}
+
+
+BinarySpikeWriter::BinarySpikeWriter(const std::string& filename, int nNeurons, bool append)
+	: position(0),
+	  window(0),
+	  blocks((nNeurons + BLOCK_SIZE - 1) / BLOCK_SIZE)
+{
+	// continue a complete file where its index starts, the new index replaces it
+	if (append && readIndex(filename, nNeurons) && truncate(filename.c_str(), position) == 0) {
+		file.open(filename, std::ios::binary | std::ios::app);
+		return;
+	}
+	footer.clear();
+	window = 0;
+
+	file.open(filename, std::ios::binary);
+
+	SpikeFormat::Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, SpikeFormat::MAGIC, sizeof(header.magic));
+	header.version = SpikeFormat::VERSION;
+	header.byteOrder = SpikeFormat::ENDIANNESS;
+	header.windowLength = WINDOW_LENGTH;
+	header.blockSize = BLOCK_SIZE;
+	header.nNeurons = nNeurons;
+
+	file.write((const char*) &header, sizeof(header));
+	position = sizeof(header);
+}
+
+// get whether the file could be opened
+bool BinarySpikeWriter::isOpen() const {
+	return file.is_open();
+}
+
+// sort spikes in the blocks of their window
+void BinarySpikeWriter::write(const Spike* spikes, std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i) {
+		assert(spikes[i].time >= window);
+
+		// the window is complete when a later spike arrives
+		if (spikes[i].time >= window + WINDOW_LENGTH) {
+			flush();
+			window = spikes[i].time - spikes[i].time % WINDOW_LENGTH;
+		}
+
+		const int block = spikes[i].neuron / BLOCK_SIZE;
+		assert(0 <= block && block < (int) blocks.size());
+		blocks[block].push_back(SpikeFormat::encode(spikes[i].time, spikes[i].neuron, window, block * BLOCK_SIZE));
+	}
+}
+
+// write the last window and the index
+void BinarySpikeWriter::close(long end) {
+	if (!file.is_open())
+		return;
+
+	flush();
+
+	SpikeFormat::Trailer trailer;
+	trailer.footer = position;
+	trailer.nChunks = footer.size();
+	trailer.end = end;
+	std::memcpy(trailer.magic, SpikeFormat::END, sizeof(trailer.magic));
+
+	file.write((const char*) footer.data(), footer.size() * sizeof(SpikeFormat::Entry));
+	file.write((const char*) &trailer, sizeof(trailer));
+	file.close();
+}
+
+// write the chunks of the current window
+void BinarySpikeWriter::flush() {
+	for (std::size_t block = 0; block < blocks.size(); ++block) {
+		std::vector<uint32_t>& records = blocks[block];
+		if (records.empty())
+			continue;
+
+		footer.push_back({ position, records.size(), window, block * BLOCK_SIZE });
+
+		file.write((const char*) records.data(), records.size() * sizeof(uint32_t));
+		position += records.size() * sizeof(uint32_t);
+		records.clear();
+	}
+
+	file.flush();
+}
+
+// read the index of a complete file
+bool BinarySpikeWriter::readIndex(const std::string& filename, int nNeurons) {
+	std::ifstream in(filename, std::ios::binary | std::ios::ate);
+	if (!in)
+		return false;
+
+	const uint64_t size = in.tellg();
+	if (size < sizeof(SpikeFormat::Header) + sizeof(SpikeFormat::Trailer))
+		return false;
+
+	SpikeFormat::Header header;
+	SpikeFormat::Trailer trailer;
+	in.seekg(0);
+	in.read((char*) &header, sizeof(header));
+	in.seekg(size - sizeof(trailer));
+	in.read((char*) &trailer, sizeof(trailer));
+
+	if (!in || std::memcmp(header.magic, SpikeFormat::MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != SpikeFormat::VERSION || header.byteOrder != SpikeFormat::ENDIANNESS ||
+		header.nNeurons != (uint64_t) nNeurons || std::memcmp(trailer.magic, SpikeFormat::END, sizeof(trailer.magic)) != 0 ||
+		trailer.footer + trailer.nChunks * sizeof(SpikeFormat::Entry) + sizeof(trailer) != size)
+		return false;
+
+	footer.resize(trailer.nChunks);
+	in.seekg(trailer.footer);
+	in.read((char*) footer.data(), footer.size() * sizeof(SpikeFormat::Entry));
+	if (!in) {
+		footer.clear();
+		return false;
+	}
+
+	// the next spikes replace the index
+	position = trailer.footer;
+	window = trailer.end - trailer.end % WINDOW_LENGTH;
+	return true;
+}
@@ -0,0 +1,188 @@
+#ifndef SPIKE_WRITER_H
+#define SPIKE_WRITER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include "ThreadPool.hpp"
+
+/// A spike
+struct Spike {
+	long time;		//!< step of the spike
+	int neuron;		//!< index of the spiking neuron
+};
+
+/// Layout of the binary spike files
+namespace SpikeFormat {
+
+	/// Start of the file
+	struct Header {
+		char magic[8];			//!< identifies the file
+		uint32_t version;		//!< version of the format
+		uint32_t byteOrder;		//!< ENDIANNESS as written, to detect other architectures
+		uint32_t windowLength;	//!< number of steps of a window
+		uint32_t blockSize;		//!< number of neurons of a block
+		uint64_t nNeurons;		//!< number of neurons
+		uint64_t reserved[4];	//!< pads the header to a cache line
+	};
+
+	/// Index of one chunk, in the footer
+	struct Entry {
+		uint64_t offset;		//!< position of the chunk in the file, in bytes
+		uint64_t nSpikes;		//!< number of records of the chunk
+		int64_t window;			//!< first step of the chunk's window
+		uint64_t block;			//!< first neuron of the chunk's block
+	};
+
+	/// End of the file
+	struct Trailer {
+		uint64_t footer;		//!< position of the footer, in bytes
+		uint64_t nChunks;		//!< number of entries of the footer
+		int64_t end;			//!< step at which the simulation ended
+		char magic[8];			//!< identifies a complete file
+	};
+
+	constexpr char MAGIC[8] = { 'B', 'R', 'U', 'N', 'E', 'L', 'S', 'P' };
+	constexpr char END[8] = { 'S', 'P', 'K', 'I', 'N', 'D', 'E', 'X' };
+	constexpr uint32_t VERSION = 1;
+	constexpr uint32_t ENDIANNESS = 0x01020304;
+
+	/// Record of a spike, relative to its window and block
+	inline uint32_t encode(long time, int neuron, long window, int block) {
+		return (uint32_t) (time - window) | (uint32_t) (neuron - block) << 16;
+	}
+}
+
+/** \brief Destination of the spikes of a simulation
+ *
+ * Receives the spikes in order of time, then neuron.
+ * */
+class SpikeWriter {
+
+public:
+	/// Default destructor
+	virtual ~SpikeWriter() = default;
+
+	/// Get whether the file could be opened
+	virtual bool isOpen() const = 0;
+
+	/// Write \p n spikes, following the previous ones in order
+	virtual void write(const Spike* spikes, std::size_t n) = 0;
+
+	/// Write the remaining data, the simulation ended at step \p end
+	virtual void close(long end) = 0;
+
+	/*! \brief Open a writer for a file
+	 *
+	 * \param filename		the file
+	 * \param format		"gdf" for text, "binary" for SpikeReader
+	 * \param nNeurons		number of neurons of the simulation
+	 * \param nThreads		number of threads formatting text
+	 * \param append		true to write after the spikes of an existing file
+	 */
+	static std::unique_ptr<SpikeWriter> open(const std::string& filename, const std::string& format, int nNeurons,
+											 int nThreads = 1, bool append = false);
+};
+
+
+/** \brief Text spikes, one "time	neuron" line per spike
+ *
+ * Integers are formatted by hand, two digits at a time, into a large buffer
+ * written at once when full. Large batches of spikes are split between
+ * several threads, each one formatting its part into a buffer of its own,
+ * written in order.
+ * */
+class TextSpikeWriter : public SpikeWriter {
+
+public:
+	/*! \brief TextSpikeWriter constructor
+	 *
+	 * \param filename		the file
+	 * \param nThreads		number of threads formatting large batches
+	 * \param append		true to write after the end of an existing file
+	 */
+	explicit TextSpikeWriter(const std::string& filename, int nThreads = 1, bool append = false);
+
+	virtual bool isOpen() const override;
+	virtual void write(const Spike* spikes, std::size_t n) override;
+	virtual void close(long end) override;
+
+	/*! \brief Format one line per spike
+	 *
+	 * \param out		destination, with room for MAX_LINE characters per spike
+	 * \param spikes	the spikes
+	 * \param n			number of spikes
+	 * \return the end of the written text
+	 */
+	static char* format(char* out, const Spike* spikes, std::size_t n);
+
+	/// Maximum length of a line
+	static constexpr std::size_t MAX_LINE = 32;
+
+private:
+
+	/// Write the buffer to the file
+	void drain();
+
+	std::ofstream file;							//!< the written file
+	std::vector<char> buffer;					//!< text not written yet
+	std::size_t used;							//!< number of characters of the buffer in use
+
+	std::unique_ptr<ThreadPool> pool;			//!< threads formatting large batches, if more than one
+	std::vector<std::vector<char>> parts;		//!< text formatted by every thread
+};
+
+
+/** \brief Binary spikes, indexed by time window and neuron block
+ *
+ * The file holds a header, chunks of 4-byte records, a footer indexing the chunks
+ * and a trailer pointing to the footer, all in native byte order.
+ * The spikes of every window of WINDOW_LENGTH steps are split into chunks
+ * of BLOCK_SIZE neurons, and every record holds the step and the neuron
+ * relative to the start of its window and block, as two 16-bit integers.
+ * SpikeReader maps the file and decodes the chunks overlapping a slice only.
+ *
+ * Appending to a complete file cuts it back to the start of its footer and writes
+ * the new chunks over its index: the file keeps its chunks, and the new footer
+ * and trailer index the chunks of both.
+ * */
+class BinarySpikeWriter : public SpikeWriter {
+
+public:
+	/// Number of steps of a window
+	static constexpr int WINDOW_LENGTH = 1000;
+
+	/// Number of neurons of a block
+	static constexpr int BLOCK_SIZE = 4096;
+
+	/*! \brief BinarySpikeWriter constructor
+	 *
+	 * \param filename		the file
+	 * \param nNeurons		number of neurons of the simulation
+	 * \param append		true to add spikes to a complete file of as many neurons, if there is one
+	 */
+	BinarySpikeWriter(const std::string& filename, int nNeurons, bool append = false);
+
+	virtual bool isOpen() const override;
+	virtual void write(const Spike* spikes, std::size_t n) override;
+	virtual void close(long end) override;
+
+private:
+
+	/// Write the chunks of the current window
+	void flush();
+
+	/// Read the index of a complete file of \p nNeurons neurons and continue where it starts, return false if there is none
+	bool readIndex(const std::string& filename, int nNeurons);
+
+	std::ofstream file;								//!< the written file
+	uint64_t position;								//!< bytes written so far
+
+	long window;									//!< first step of the current window
+	std::vector<std::vector<uint32_t>> blocks;		//!< records of every block of the current window
+	std::vector<SpikeFormat::Entry> footer;			//!< index of the written chunks
+};
+
+#endif
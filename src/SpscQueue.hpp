@@ -0,0 +1,56 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/** \brief Bounded lock-free queue between one producer and one consumer thread
+ *
+ * push() is only called by the producer, pop() only by the consumer.
+ * Head and tail are kept a cache line apart, so that the two threads
+ * do not invalidate each other's line on every operation.
+ * */
+template<typename T>
+class SpscQueue {
+
+public:
+	/// SpscQueue constructor, holding up to \p capacity elements
+	explicit SpscQueue(std::size_t capacity)
+		: slots(capacity + 1), head(0), tail(0)
+	{}
+
+	/// Add an element, return false if the queue is full
+	bool push(const T& value) {
+		const std::size_t t = tail.load(std::memory_order_relaxed);
+		const std::size_t next = t + 1 == slots.size() ? 0 : t + 1;
+
+		if (next == head.load(std::memory_order_acquire))
+			return false;
+
+		slots[t] = value;
+		tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/// Remove the oldest element, return false if the queue is empty
+	bool pop(T& value) {
+		const std::size_t h = head.load(std::memory_order_relaxed);
+
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+
+		value = slots[h];
+		head.store(h + 1 == slots.size() ? 0 : h + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+
+	std::vector<T> slots;							//!< ring of elements, one slot always free
+	std::atomic<std::size_t> head;					//!< next element to pop, written by the consumer
+	char padding[64 - sizeof(std::atomic<std::size_t>)];
+	std::atomic<std::size_t> tail;					//!< next slot to push, written by the producer
+};
+
+#endif
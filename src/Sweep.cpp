@@ -0,0 +1,162 @@
+#include <sstream>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <cmath>
+#include "Sweep.hpp"
+#include "Network.hpp"
+#include "ThreadPool.hpp"
+#include "Current.hpp"
+
+namespace {
+
+	/// Parse a whole string as a number
+	double parseNumber(const std::string& text) {
+		std::istringstream in(text);
+		double value;
+
+		if (!(in >> value) || !(in >> std::ws).eof()) {
+			throw std::invalid_argument("invalid value '" + text + "' in sweep");
+		}
+
+		return value;
+	}
+
+	/// Get the file of a point: \p filename with the point before its extension
+	std::string getPointFile(const std::string& filename, double eta, double g) {
+		const std::size_t slash = filename.rfind('/'), dot = filename.rfind('.');
+		const std::size_t end = dot != std::string::npos && (slash == std::string::npos || dot > slash) ? dot : filename.size();
+
+		std::ostringstream ss;
+		ss << filename.substr(0, end) << "_eta" << eta << "_g" << g << filename.substr(end);
+		return ss.str();
+	}
+}
+
+Sweep::Sweep(const Config& c, const std::vector<double>& etas, const std::vector<double>& gs)
+	: config(c)
+{
+	for (double eta : etas) {
+		for (double g : gs) {
+			points.push_back({ eta, g, 0, 0.0, 0.0, 0.0 });
+		}
+	}
+
+	if (!config.proceduralConnections) {
+		synapses = Network::createSynapses(config);
+	}
+}
+
+// parse the values of one parameter
+std::vector<double> Sweep::parseGrid(const std::string& grid) {
+	std::vector<double> values;
+	std::string item;
+
+	if (grid.find(':') != std::string::npos) {
+		// range first:last:step
+		std::istringstream in(grid);
+		std::vector<double> bounds;
+		while (std::getline(in, item, ':')) {
+			bounds.push_back(parseNumber(item));
+		}
+
+		if (bounds.size() != 3 || bounds[2] <= 0.0 || bounds[1] < bounds[0]) {
+			throw std::invalid_argument("invalid range '" + grid + "' in sweep, expected first:last:step");
+		}
+
+		// computed from the first value so that errors do not add up
+		const long n = std::floor((bounds[1] - bounds[0]) / bounds[2] + 1E-9) + 1;
+		for (long i = 0; i < n; ++i) {
+			values.push_back(bounds[0] + i * bounds[2]);
+		}
+	} else {
+		// list a,b,c
+		std::istringstream in(grid);
+		while (std::getline(in, item, ',')) {
+			values.push_back(parseNumber(item));
+		}
+	}
+
+	if (values.empty()) {
+		throw std::invalid_argument("empty sweep '" + grid + "'");
+	}
+
+	return values;
+}
+
+// simulate all points
+void Sweep::run(bool save) {
+	std::atomic<int> next(0);
+	std::mutex mutex;
+	int nDone = 0;
+
+	ThreadPool pool(std::min<int>(config.nThreads, points.size()));
+
+	// every thread simulates the next point until there are none left
+	pool.run([&](int) {
+		for (int i = next++; i < (int) points.size(); i = next++) {
+			simulate(points[i], save);
+
+			if (config.verbose) {
+				std::lock_guard<std::mutex> lock(mutex);
+				std::cout << "eta " << points[i].eta << ", g " << points[i].g <<
+					'\t' << "[" << ++nDone << "/" << points.size() << ", " << points[i].rate << " Hz]" << std::endl;
+			}
+		}
+	});
+}
+
+// simulate one point
+void Sweep::simulate(Point& point, bool save) const {
+	Config pointConfig = config;
+	pointConfig.eta = point.eta;
+	pointConfig.g = point.g;
+	pointConfig.nThreads = 1;
+	pointConfig.noiseProducer = false;
+	pointConfig.output = "";
+	pointConfig.recordSpikes = save && config.recordSpikes;
+	pointConfig.verbose = false;
+
+	// every point writes its own files
+	if (!config.statistics.empty()) {
+		pointConfig.statistics = getPointFile(config.statistics, point.eta, point.g);
+	}
+	if (!config.profile.empty()) {
+		pointConfig.profile = getPointFile(config.profile, point.eta, point.g);
+	}
+	if (!config.trace.empty()) {
+		pointConfig.trace = getPointFile(config.trace, point.eta, point.g);
+	}
+
+	Current current(pointConfig.current, pointConfig.currentStart, pointConfig.currentEnd);
+	Network network(&current, pointConfig, synapses);
+	network.run();
+
+	if (pointConfig.recordSpikes || !pointConfig.statistics.empty()) {
+		network.save();
+	}
+
+	// number of spikes of every bin
+	const PopulationStatistics& statistics = network.getStatistics();
+	point.nSpikes = statistics.getNbSpikes();
+	point.rate = statistics.getRate();
+
+	const double mean = statistics.getNbBins() > 0 ? point.nSpikes / (double) statistics.getNbBins() : 0.0;
+	point.activityCv = mean > 0.0 ? std::sqrt(statistics.getCountVariance()) / mean : 0.0;
+	point.isiCv = statistics.getIsiCv();
+}
+
+// get the summaries of all points
+const std::vector<Sweep::Point>& Sweep::getPoints() const {
+	return points;
+}
+
+// write the summaries of all points
+void Sweep::write(std::ostream& out) const {
+	out << "eta" << '\t' << "g" << '\t' << "spikes" << '\t' << "rate" << '\t' << "activity_cv" << '\t' << "isi_cv" << '\n';
+
+	for (const Point& point : points) {
+		out << point.eta << '\t' << point.g << '\t' << point.nSpikes << '\t' <<
+			point.rate << '\t' << point.activityCv << '\t' << point.isiCv << '\n';
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <iostream>
+#include "Config.hpp"
+#include "SynapseMatrix.hpp"
+
+/** \brief Simulations of a grid of (eta, g) parameter points
+ *
+ * The connections only depend on the populations and the connectivity,
+ * so they are drawn once and shared read-only by all points.
+ * The points are simulated concurrently, one per thread of a pool,
+ * each one writing its own result file and statistics file, named after the point,
+ * and summarised from its PopulationStatistics without keeping the spikes unless they are saved.
+ * */
+class Sweep {
+
+public:
+	/// Summary of the simulation of one parameter point
+	struct Point {
+		double eta, g;				//!< the parameter point
+		long nSpikes;				//!< number of spikes of the whole network
+		double rate;				//!< mean firing rate of a neuron, in Hz
+		double activityCv;			//!< coefficient of variation of the number of spikes per bin of statistics_bin steps
+		double isiCv;				//!< mean coefficient of variation of the inter-spike intervals of a neuron
+	};
+
+	/*! \brief Sweep constructor
+	 *
+	 * Draws the connections shared by all points.
+	 *
+	 * \param config		the parameters of all points, but eta and g
+	 * \param etas			the values of eta
+	 * \param gs			the values of g
+	 */
+	Sweep(const Config& config, const std::vector<double>& etas, const std::vector<double>& gs);
+
+	/// Default destructor
+	virtual ~Sweep() = default;
+
+	/*! \brief Parse the values of one parameter
+	 *
+	 * \param grid		"first:last:step" for a range including both ends,
+	 * 					or a list of values "a,b,c"
+	 */
+	static std::vector<double> parseGrid(const std::string& grid);
+
+	/*! \brief Simulate all points
+	 *
+	 * Config::nThreads points are simulated at once, on one thread each.
+	 *
+	 * \param save		true to write the spikes of every point to its result file, if Config::recordSpikes
+	 */
+	void run(bool save = true);
+
+	/// Get the summaries of all points, by eta then g
+	const std::vector<Point>& getPoints() const;
+
+	/// Write the summaries of all points as a tab separated table
+	void write(std::ostream& out) const;
+
+private:
+
+	/// Simulate one point and fill its summary
+	void simulate(Point& point, bool save) const;
+
+	Config config;										//!< parameters of all points
+	std::vector<Point> points;							//!< all points, by eta then g
+	std::shared_ptr<const SynapseMatrix> synapses;		//!< connections shared by all points, unless procedural
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SynapseMatrix.hpp"
+
+constexpr int SynapseMatrix::PAGE_BITS;
+constexpr int SynapseMatrix::PAGE_SIZE;
+
+namespace {
+
+	/// Header of a saved matrix, followed by the offsets then the targets
+	struct Header {
+		char magic[8];			//!< identifies the file
+		uint32_t version;		//!< version of the format
+		uint32_t byteOrder;		//!< ENDIANNESS as written, to detect other architectures
+		uint64_t hash;			//!< hash of the parameters the matrix was built from
+		uint64_t seed;			//!< seed the matrix was drawn with
+		uint64_t nNeurons;		//!< number of neurons
+		uint64_t nSynapses;		//!< number of synapses
+		uint64_t nPages;		//!< number of pages of targets
+		uint64_t reserved;		//!< pads the header to a cache line
+	};
+
+	static_assert(sizeof(Header) == 64, "the header is one cache line");
+	static_assert(sizeof(std::size_t) == sizeof(uint64_t), "offsets are saved as 64-bit integers");
+
+	constexpr char MAGIC[8] = { 'B', 'R', 'U', 'N', 'E', 'L', 'S', 'M' };
+	constexpr uint32_t VERSION = 2;
+	constexpr uint32_t ENDIANNESS = 0x01020304;
+
+	/// Get the size of a file holding a matrix
+	std::size_t getFileSize(uint64_t nNeurons, uint64_t nPages, uint64_t nSynapses) {
+		return sizeof(Header) + (nNeurons * nPages + 1) * sizeof(std::size_t) + nSynapses * sizeof(uint16_t);
+	}
+}
+
+SynapseMatrix::SynapseMatrix()
+	: offsets(1, 0),
+	  nNeurons(0), nPages(0)
+{
+	attach();
+}
+
+SynapseMatrix::SynapseMatrix(int size, int inDegree, const std::vector<int>& sources, ThreadPool& pool, int firstTarget)
+	: offsets((std::size_t) size * getNbPages(size) + 1, 0),
+	  targets(sources.size()),
+	  nNeurons(size), nPages(getNbPages(size))
+{
+	const int nTargets = inDegree > 0 ? sources.size() / inDegree : size - firstTarget;
+	assert(sources.size() == (std::size_t) nTargets * inDegree && 0 <= firstTarget && firstTarget + nTargets <= size);
+
+	// synapses counted by every thread for every source and page, then position of the thread's targets
+	const int nThreads = pool.size();
+	std::vector<std::vector<uint32_t>> counts(nThreads);
+
+	auto getFirst = [&](int n, int thread) { return (int) ((long) n * thread / nThreads); };
+
+	pool.run([&](int thread) {
+		// first pass: count the sources of the thread's targets
+		const int first = firstTarget + getFirst(nTargets, thread), last = firstTarget + getFirst(nTargets, thread + 1);
+		std::vector<uint32_t>& count = counts[thread];
+		count.assign(offsets.size() - 1, 0);
+
+		for (int target = first; target < last; ++target) {
+			for (int k = 0; k < inDegree; ++k) {
+				int source = sources[(std::size_t) (target - firstTarget) * inDegree + k];
+				assert(0 <= source && source < size);
+				++count[(std::size_t) source * nPages + (target >> PAGE_BITS)];
+			}
+		}
+
+		pool.sync();
+
+		// for the thread's sources: out-degree in every page, and where every thread starts within it
+		const int firstSource = getFirst(size, thread), lastSource = getFirst(size, thread + 1);
+		for (std::size_t key = (std::size_t) firstSource * nPages; key < (std::size_t) lastSource * nPages; ++key) {
+			uint32_t degree = 0;
+			for (int i = 0; i < nThreads; ++i) {
+				uint32_t n = counts[i][key];
+				counts[i][key] = degree;
+				degree += n;
+			}
+			offsets[key + 1] = degree;
+		}
+
+		pool.sync();
+
+		// prefix sum: start of the targets of every source and page
+		if (thread == 0) {
+			for (std::size_t i = 0; i + 1 < offsets.size(); ++i) {
+				offsets[i + 1] += offsets[i];
+			}
+		}
+
+		pool.sync();
+
+		// second pass: fill in the targets, in increasing order for every source
+		for (int target = first; target < last; ++target) {
+			for (int k = 0; k < inDegree; ++k) {
+				std::size_t key = (std::size_t) sources[(std::size_t) (target - firstTarget) * inDegree + k] * nPages + (target >> PAGE_BITS);
+				targets[offsets[key] + count[key]++] = target & (PAGE_SIZE - 1);
+			}
+		}
+	});
+
+	attach();
+}
+
+// save the matrix to a binary file
+bool SynapseMatrix::save(const std::string& filename, uint64_t hash, uint64_t seed) const {
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.byteOrder = ENDIANNESS;
+	header.hash = hash;
+	header.seed = seed;
+	header.nNeurons = nNeurons;
+	header.nPages = nPages;
+	header.nSynapses = nSynapses;
+
+	// write a temporary file, then replace the cache at once
+	const std::string temporary = filename + ".tmp" + std::to_string(getpid());
+	{
+		std::ofstream out(temporary, std::ios::binary);
+		out.write((const char*) &header, sizeof(header));
+		out.write((const char*) offsetData, ((std::size_t) nNeurons * nPages + 1) * sizeof(std::size_t));
+		out.write((const char*) targetData, nSynapses * sizeof(uint16_t));
+
+		if (!out) {
+			std::remove(temporary.c_str());
+			return false;
+		}
+	}
+
+	return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+// map a saved matrix in memory
+std::shared_ptr<const SynapseMatrix> SynapseMatrix::load(const std::string& filename, uint64_t hash) {
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return nullptr;
+
+	struct stat status;
+	void* data = MAP_FAILED;
+	std::size_t size = 0;
+
+	if (fstat(file, &status) == 0 && (std::size_t) status.st_size >= sizeof(Header)) {
+		size = status.st_size;
+		data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	}
+
+	// the mapping stays valid without the file descriptor
+	close(file);
+
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	std::shared_ptr<void> mapping(data, [size](void* p) { munmap(p, size); });
+
+	// check the header before trusting the data
+	const Header& header = *(const Header*) data;
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+		header.byteOrder != ENDIANNESS || header.hash != hash ||
+		header.nNeurons >= (uint64_t) INT32_MAX || header.nPages != (uint64_t) getNbPages(header.nNeurons) ||
+		size != getFileSize(header.nNeurons, header.nPages, header.nSynapses))
+		return nullptr;
+
+	const std::size_t nOffsets = header.nNeurons * header.nPages + 1;
+	const std::size_t* offsets = (const std::size_t*) ((const char*) data + sizeof(Header));
+	// the offsets of every source and page follow each other, within the targets
+	if (offsets[0] != 0 || offsets[nOffsets - 1] != header.nSynapses || !std::is_sorted(offsets, offsets + nOffsets))
+		return nullptr;
+
+	std::shared_ptr<SynapseMatrix> matrix(new SynapseMatrix());
+	matrix->nNeurons = header.nNeurons;
+	matrix->nPages = header.nPages;
+	matrix->nSynapses = header.nSynapses;
+	matrix->offsetData = offsets;
+	matrix->targetData = (const uint16_t*) (offsets + nOffsets);
+	matrix->mapping = mapping;
+
+	return matrix;
+}
+
+// point the data to the owned offsets and targets
+void SynapseMatrix::attach() {
+	nSynapses = targets.size();
+	offsetData = offsets.data();
+	targetData = targets.data();
+}
+
+
+// get the number of neurons
+int SynapseMatrix::size() const {
+	return nNeurons;
+}
+
+// get the number of pages of targets
+int SynapseMatrix::getNbPages() const {
+	return nPages;
+}
+
+// get the targets of a neuron
+std::vector<int> SynapseMatrix::getTargets(int source) const {
+	std::vector<int> result;
+	result.reserve(getNbTargets(source));
+	forEachTarget(source, 0, nNeurons, [&](int target) { result.push_back(target); });
+	return result;
+}
+
+// get the total number of synapses
+std::size_t SynapseMatrix::getNbSynapses() const {
+	return nSynapses;
+}
+
+// get the memory used by the offsets and targets
+std::size_t SynapseMatrix::getMemoryUsage() const {
+	return ((std::size_t) nNeurons * nPages + 1) * sizeof(std::size_t) + nSynapses * sizeof(uint16_t);
+}
+
+// get whether the matrix is mapped from a file
+bool SynapseMatrix::isMapped() const {
+	return mapping != nullptr;
+}
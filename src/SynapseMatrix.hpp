@@ -0,0 +1,157 @@
+#ifndef SYNAPSE_MATRIX_H
+#define SYNAPSE_MATRIX_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+/** \brief Connectome stored in compressed sparse row format
+ *
+ * The targets of all neurons are packed in one array, sorted by source.
+ * To halve the memory traffic of spike delivery, targets are stored
+ * as 16-bit indices local to pages of PAGE_SIZE neurons: the targets of neuron \p i
+ * in page \p p are found between offsets[i * nPages + p] and offsets[i * nPages + p + 1].
+ * Within one source, targets are stored in increasing order.
+ *
+ * The matrix can be saved to a binary file and mapped back in memory
+ * without parsing: processes mapping the same file share its pages.
+ * */
+class SynapseMatrix {
+
+public:
+	/// Number of bits of a target index local to its page
+	static constexpr int PAGE_BITS = 16;
+
+	/// Number of neurons in a page
+	static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+	/// Default constructor, empty connectome
+	SynapseMatrix();
+
+	/*! \brief SynapseMatrix constructor, on a pool of threads
+	 *
+	 *  Builds the matrix from the sources of every neuron, in two passes:
+	 *  the out-degree of every source is counted first, then the targets are filled in.
+	 *  Parallel counting sort: every thread counts the sources of its own range
+	 *  of targets, which gives each thread a disjoint slot in the targets of every source.
+	 *  The result does not depend on the number of threads.
+	 *
+	 *  The sources may only cover a range of targets, e.g. the neurons of one process,
+	 *  the matrix then holds the connections to these targets only.
+	 *
+	 *  \param size			number of neurons
+	 *  \param inDegree		number of sources of every neuron
+	 *  \param sources		the \p inDegree sources of neuron \p firstTarget, then of the next one, ...
+	 *  \param pool			threads building the matrix
+	 *  \param firstTarget	the first neuron whose sources are given
+	 */
+	SynapseMatrix(int size, int inDegree, const std::vector<int>& sources, ThreadPool& pool, int firstTarget = 0);
+
+	/// Move constructor, the targets stay in place
+	SynapseMatrix(SynapseMatrix&&) = default;
+
+	/// Move assignment, the targets stay in place
+	SynapseMatrix& operator=(SynapseMatrix&&) = default;
+
+	/// Not copyable, share it instead
+	SynapseMatrix(const SynapseMatrix&) = delete;
+	SynapseMatrix& operator=(const SynapseMatrix&) = delete;
+
+
+	/*! \brief Save the matrix to a binary file
+	 *
+	 *  The file is written next to \p filename then renamed,
+	 *  so that other processes never map a partial file.
+	 *
+	 *  \param filename		the file
+	 *  \param hash			hash of the parameters the matrix was built from
+	 *  \param seed			seed the matrix was drawn with
+	 *  \return false if the file could not be written
+	 */
+	bool save(const std::string& filename, uint64_t hash, uint64_t seed) const;
+
+	/*! \brief Map a matrix saved by save() in memory
+	 *
+	 *  \param filename		the file
+	 *  \param hash			expected hash of the parameters
+	 *  \return the matrix, or nullptr if the file is missing, invalid,
+	 *  		or was built from other parameters
+	 */
+	static std::shared_ptr<const SynapseMatrix> load(const std::string& filename, uint64_t hash);
+
+
+	/// Get the number of neurons
+	int size() const;
+
+	/// Get the total number of synapses
+	std::size_t getNbSynapses() const;
+
+	/// Get the number of pages of targets
+	int getNbPages() const;
+
+	/// Get the number of targets of neuron \p source
+	std::size_t getNbTargets(int source) const {
+		return offsetData[(std::size_t) (source + 1) * nPages] - offsetData[(std::size_t) source * nPages];
+	}
+
+	/// Get the targets of neuron \p source, in increasing order
+	std::vector<int> getTargets(int source) const;
+
+	/*! \brief Decode the targets of a neuron within a range
+	 *
+	 * \param source	index of the neuron
+	 * \param first		index of the first target of the range
+	 * \param last		index after the last target of the range
+	 * \param function	called with every target in the range, in increasing order
+	 */
+	template<typename Function>
+	void forEachTarget(int source, int first, int last, Function function) const {
+		if (first >= last)
+			return;
+
+		const std::size_t* pages = offsetData + (std::size_t) source * nPages;
+
+		for (int page = first >> PAGE_BITS; page <= (last - 1) >> PAGE_BITS; ++page) {
+			const uint16_t* begin = targetData + pages[page];
+			const uint16_t* end = targetData + pages[page + 1];
+			const int base = page << PAGE_BITS;
+
+			// targets are sorted, skip to the first one in the range
+			const int localLast = last - base;
+			for (const uint16_t* it = first > base ? std::lower_bound(begin, end, first - base) : begin;
+				 it != end && *it < localLast; ++it) {
+				function(base + *it);
+			}
+		}
+	}
+
+	/// Get the number of bytes used by the connectome
+	std::size_t getMemoryUsage() const;
+
+	/// Get whether the matrix is mapped from a file
+	bool isMapped() const;
+
+private:
+
+	/// Point the data to the owned offsets and targets
+	void attach();
+
+	/// Get the number of pages of \p size neurons
+	static int getNbPages(int size) { return (size + PAGE_SIZE - 1) >> PAGE_BITS; }
+
+	std::vector<std::size_t> offsets;	//!< start of the targets of every neuron and page, plus the total
+	std::vector<uint16_t> targets;		//!< targets of all neurons, local to their page, packed
+
+	int nNeurons;						//!< number of neurons
+	int nPages;							//!< number of pages of targets
+	std::size_t nSynapses;				//!< number of synapses
+	const std::size_t* offsetData;		//!< the offsets, owned or mapped
+	const uint16_t* targetData;			//!< the targets, owned or mapped
+	std::shared_ptr<void> mapping;		//!< the mapped file, unmapped with the last matrix using it
+};
+
+#endif
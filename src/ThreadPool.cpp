@@ -0,0 +1,107 @@
+#include <cassert>
+#include "ThreadPool.hpp"
+
+Barrier::Barrier(int n)
+	: nThreads(n), waiting(0), generation(0)
+{
+	assert(nThreads > 0);
+}
+
+void Barrier::wait() {
+	// nothing to wait for with a single thread
+	if (nThreads == 1)
+		return;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	long arrivedIn = generation;
+
+	// the last thread to arrive releases the others
+	if (++waiting == nThreads) {
+		waiting = 0;
+		++generation;
+		condition.notify_all();
+	} else {
+		condition.wait(lock, [&]() { return generation != arrivedIn; });
+	}
+}
+
+
+ThreadPool::ThreadPool(int nThreads)
+	: task(nullptr), generation(0), pending(0), stopping(false),
+	  barrier(nThreads)
+{
+	assert(nThreads > 0);
+
+	// the calling thread is thread 0
+	for (int i = 1; i < nThreads; ++i) {
+		workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+// get the number of threads
+int ThreadPool::size() const {
+	return workers.size() + 1;
+}
+
+// run the task on all threads and wait for them
+void ThreadPool::run(const std::function<void(int)>& t) {
+	if (!workers.empty()) {
+		std::lock_guard<std::mutex> lock(mutex);
+		task = &t;
+		pending = workers.size();
+		++generation;
+	}
+	wake.notify_all();
+
+	// take part as thread 0
+	t(0);
+
+	// wait for the workers
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&]() { return pending == 0; });
+	task = nullptr;
+}
+
+// barrier between the threads of the current task
+void ThreadPool::sync() {
+	barrier.wait();
+}
+
+// wait for tasks and run them
+void ThreadPool::work(int id) {
+	long seen = 0;
+
+	while (true) {
+		const std::function<void(int)>* current;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stopping || generation != seen; });
+
+			if (stopping)
+				return;
+
+			seen = generation;
+			current = task;
+		}
+
+		(*current)(id);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--pending;
+		}
+		done.notify_one();
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/** \brief Reusable synchronisation point for a fixed number of threads
+ * */
+class Barrier {
+
+public:
+	/// Barrier constructor, for \p nThreads threads
+	explicit Barrier(int nThreads);
+
+	/// Block until all threads have reached the barrier
+	void wait();
+
+private:
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	int nThreads;			//!< number of threads to wait for
+	int waiting;			//!< number of threads currently waiting
+	long generation;		//!< number of times the barrier was passed
+};
+
+
+/** \brief Fixed set of worker threads running the same task
+ *
+ * The calling thread takes part in every task as thread 0,
+ * so a pool of size 1 does not start any thread.
+ * */
+class ThreadPool {
+
+public:
+	/// ThreadPool constructor, starts \p nThreads - 1 workers
+	explicit ThreadPool(int nThreads);
+
+	/// ThreadPool destructor, stops and joins the workers
+	virtual ~ThreadPool();
+
+	/// Get the number of threads, the calling one included
+	int size() const;
+
+	/*! \brief Run a task on every thread
+	 *
+	 *  Blocks until all threads have finished.
+	 *
+	 *  \param task		the task, called with the index of the thread running it
+	 */
+	void run(const std::function<void(int)>& task);
+
+	/// Synchronise the threads running the current task
+	void sync();
+
+private:
+
+	/// Main loop of the worker thread \p id
+	void work(int id);
+
+	std::vector<std::thread> workers;			//!< the worker threads
+
+	std::mutex mutex;
+	std::condition_variable wake;				//!< signals a new task or the end of the pool
+	std::condition_variable done;				//!< signals the end of a task
+
+	const std::function<void(int)>* task;		//!< the current task
+	long generation;							//!< number of tasks started
+	int pending;								//!< number of workers still running the current task
+	bool stopping;								//!< true when the pool is destroyed
+
+	Barrier barrier;							//!< barrier for sync()
+};
+
+#endif
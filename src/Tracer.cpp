@@ -0,0 +1,93 @@
+#include <cassert>
+#include <iomanip>
+#include "Tracer.hpp"
+
+namespace {
+	/// Get a time in us since \p origin
+	double microseconds(Tracer::Clock::time_point time, Tracer::Clock::time_point origin) {
+		return std::chrono::duration<double, std::micro>(time - origin).count();
+	}
+}
+
+Tracer::Tracer(int p, Clock::time_point o)
+	: process(p), origin(o)
+{}
+
+// add a track
+int Tracer::addTrack(const std::string& name) {
+	tracks.emplace_back(new Track());
+	tracks.back()->name = name;
+	return tracks.size() - 1;
+}
+
+// get the number of tracks
+int Tracer::size() const {
+	return tracks.size();
+}
+
+// get the events of a track
+const std::vector<Tracer::Event>& Tracer::getEvents(int track) const {
+	return tracks[track]->events;
+}
+
+// write the events of all tracks
+void Tracer::write(std::ostream& out) const {
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	// the names of the threads, then their events
+	for (int track = 0; track < size(); ++track) {
+		out << (track > 0 ? ",\n" : "") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << process <<
+			", \"tid\": " << track << ", \"args\": {\"name\": \"" << tracks[track]->name << "\"}}";
+	}
+
+	for (int track = 0; track < size(); ++track) {
+		for (const Event& event : tracks[track]->events) {
+			out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"ts\": " <<
+				microseconds(event.begin, origin) << ", \"dur\": " << microseconds(event.end, event.begin) <<
+				", \"pid\": " << process << ", \"tid\": " << track;
+
+			if (event.step >= 0 || event.count >= 0) {
+				out << ", \"args\": {";
+				if (event.step >= 0) {
+					out << "\"step\": " << event.step << (event.count >= 0 ? ", " : "");
+				}
+				if (event.count >= 0) {
+					out << "\"spikes\": " << event.count;
+				}
+				out << '}';
+			}
+			out << '}';
+		}
+	}
+	out << "\n]}\n";
+}
+
+
+TracedSpikeWriter::TracedSpikeWriter(std::unique_ptr<SpikeWriter> o, Tracer& t, int tr)
+	: output(std::move(o)), tracer(t), track(tr)
+{
+	assert(output != nullptr && 0 <= track && track < tracer.size());
+}
+
+// get whether the file could be opened
+bool TracedSpikeWriter::isOpen() const {
+	return output->isOpen();
+}
+
+// write spikes, tracing the writes which do write
+void TracedSpikeWriter::write(const Spike* spikes, std::size_t n) {
+	const Tracer::Clock::time_point begin = Tracer::Clock::now();
+	output->write(spikes, n);
+
+	if (n > 0) {
+		tracer.add(track, "write", "io", begin, Tracer::Clock::now(), spikes[0].time, n);
+	}
+}
+
+// write the remaining data
+void TracedSpikeWriter::close(long end) {
+	const Tracer::Clock::time_point begin = Tracer::Clock::now();
+	output->close(end);
+	tracer.add(track, "close", "io", begin, Tracer::Clock::now(), end);
+}
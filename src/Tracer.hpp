@@ -0,0 +1,101 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <ostream>
+#include "SpikeWriter.hpp"
+
+/** \brief Timeline of the threads of a simulation, for the Chrome trace viewer
+ *
+ * Every thread adds the events it times to a track of its own: a track is only written
+ * by its thread, so no lock is taken, and read by write() once the threads are done.
+ * The timeline is written in the Chrome trace_event JSON format, one complete
+ * event ("ph": "X") per span, e.g. for chrome://tracing or Perfetto.
+ * */
+class Tracer {
+
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	/// A span of time on one thread
+	struct Event {
+		const char* name;			//!< name of the event, a string literal
+		const char* category;		//!< category of the event, a string literal
+		Clock::time_point begin;	//!< start of the span
+		Clock::time_point end;		//!< end of the span
+		long step;					//!< first step of the span, -1 if none
+		long count;					//!< spikes of the span, -1 if none
+	};
+
+	/*! \brief Tracer constructor
+	 *
+	 * \param process		index of the process, e.g. the rank of a distributed simulation
+	 * \param origin		time 0 of the trace, no later than its first event
+	 */
+	explicit Tracer(int process = 0, Clock::time_point origin = Clock::now());
+
+	/// Default destructor
+	virtual ~Tracer() = default;
+
+	/// Add a track named \p name, before the threads start, and get its index
+	int addTrack(const std::string& name);
+
+	/// Add an event to track \p track, from the thread of the track
+	void add(int track, const char* name, const char* category, Clock::time_point begin, Clock::time_point end,
+			 long step = -1, long count = -1) {
+		tracks[track]->events.push_back({ name, category, begin, end, step, count });
+	}
+
+	/// Get the number of tracks
+	int size() const;
+
+	/// Get the events of a track, in the order they were added
+	const std::vector<Event>& getEvents(int track) const;
+
+	/// Write the events of all tracks as a Chrome trace_event JSON object, times in us since its origin
+	void write(std::ostream& out) const;
+
+private:
+
+	/// Events of one thread
+	struct Track {
+		std::string name;				//!< name of the thread
+		std::vector<Event> events;		//!< the events of the thread
+		char padding[64];				//!< keeps the tracks of different threads on different cache lines
+	};
+
+	int process;								//!< index of the process
+	Clock::time_point origin;					//!< time 0 of the trace
+	std::vector<std::unique_ptr<Track>> tracks;	//!< events of every thread
+};
+
+
+/** \brief Writer adding every write of another writer to a track of a Tracer
+ *
+ * The writer must only be used by the thread of the track, e.g. the writer thread of a SpikeRecorder.
+ * */
+class TracedSpikeWriter : public SpikeWriter {
+
+public:
+	/*! \brief TracedSpikeWriter constructor
+	 *
+	 * \param output		the writer of the file
+	 * \param tracer		receives the events, must outlive the writer
+	 * \param track			track of the events
+	 */
+	TracedSpikeWriter(std::unique_ptr<SpikeWriter> output, Tracer& tracer, int track);
+
+	virtual bool isOpen() const override;
+	virtual void write(const Spike* spikes, std::size_t n) override;
+	virtual void close(long end) override;
+
+private:
+	std::unique_ptr<SpikeWriter> output;	//!< the writer of the file
+	Tracer& tracer;							//!< receives the events
+	int track;								//!< track of the events
+};
+
+#endif
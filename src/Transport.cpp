@@ -0,0 +1,241 @@
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Transport.hpp"
+
+namespace {
+
+	/// Write all bytes to a socket
+	void writeAll(int socket, const void* data, std::size_t size) {
+		const char* bytes = (const char*) data;
+		while (size > 0) {
+			const ssize_t n = ::send(socket, bytes, size, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				throw std::runtime_error(std::string("cannot send to another rank: ") + std::strerror(errno));
+
+			bytes += n;
+			size -= n;
+		}
+	}
+
+	/// Read all bytes from a socket
+	void readAll(int socket, void* data, std::size_t size) {
+		char* bytes = (char*) data;
+		while (size > 0) {
+			const ssize_t n = ::recv(socket, bytes, size, 0);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				throw std::runtime_error("lost the connection to another rank");
+
+			bytes += n;
+			size -= n;
+		}
+	}
+
+	/// Get the address of a socket path
+	sockaddr_un getAddress(const std::string& path) {
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+
+		if (path.size() >= sizeof(address.sun_path))
+			throw std::runtime_error("socket path '" + path + "' is too long");
+
+		std::memcpy(address.sun_path, path.c_str(), path.size());
+		return address;
+	}
+}
+
+
+// create the transports of all ranks of a group
+std::vector<std::unique_ptr<LocalTransport>> LocalTransport::createGroup(int size) {
+	auto group = std::make_shared<Group>(size);
+
+	std::vector<std::unique_ptr<LocalTransport>> transports;
+	for (int rank = 0; rank < size; ++rank) {
+		transports.emplace_back(new LocalTransport(group, rank));
+	}
+	return transports;
+}
+
+LocalTransport::LocalTransport(std::shared_ptr<Group> g, int r)
+	: group(g), rank(r)
+{
+	assert(0 <= rank && rank < (int) group->data.size());
+}
+
+// get the index of this rank
+int LocalTransport::getRank() const {
+	return rank;
+}
+
+// get the number of ranks
+int LocalTransport::size() const {
+	return group->data.size();
+}
+
+// give the data of every rank to every rank
+void LocalTransport::allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) {
+	// every rank shows its data, then copies the data of all ranks before anyone changes it
+	group->data[rank] = &data;
+	group->barrier.wait();
+
+	all.resize(size());
+	for (int i = 0; i < size(); ++i) {
+		all[i] = *group->data[i];
+	}
+
+	group->barrier.wait();
+}
+
+
+SocketTransport::SocketTransport(const std::string& p, int r, int size, int timeout)
+	: path(p), rank(r), nRanks(size), listener(-1), connections(size, -1)
+{
+	assert(0 <= rank && rank < nRanks);
+
+	if (nRanks == 1)
+		return;
+
+	// the sockets opened so far are closed before an error propagates
+	try {
+		const sockaddr_un address = getAddress(path);
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+
+		if (rank == 0) {
+			// listen, and accept the connection of every other rank
+			listener = socket(AF_UNIX, SOCK_STREAM, 0);
+			unlink(path.c_str());
+
+			if (listener < 0 || bind(listener, (const sockaddr*) &address, sizeof(address)) != 0 || listen(listener, nRanks) != 0)
+				throw std::runtime_error("cannot listen on socket '" + path + "': " + std::strerror(errno));
+
+			for (int i = 1; i < nRanks; ++i) {
+				pollfd request = { listener, POLLIN, 0 };
+				const long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+				if (remaining <= 0 || poll(&request, 1, remaining) <= 0)
+					throw std::runtime_error("timed out waiting for the other ranks on '" + path + "'");
+
+				const int connection = accept(listener, nullptr, nullptr);
+				if (connection < 0)
+					throw std::runtime_error("cannot accept a rank on '" + path + "'");
+
+				// every rank starts by telling its index
+				int32_t other = -1;
+				try {
+					readAll(connection, &other, sizeof(other));
+				} catch (const std::runtime_error&) {
+					close(connection);
+					throw;
+				}
+				if (other <= 0 || other >= nRanks || connections[other] >= 0) {
+					close(connection);
+					throw std::runtime_error("unexpected rank " + std::to_string(other) + " on '" + path + "'");
+				}
+
+				connections[other] = connection;
+			}
+		} else {
+			// connect to rank 0, once it listens
+			while (true) {
+				const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+				if (connection >= 0 && connect(connection, (const sockaddr*) &address, sizeof(address)) == 0) {
+					connections[0] = connection;
+					break;
+				}
+				if (connection >= 0) {
+					close(connection);
+				}
+
+				if (std::chrono::steady_clock::now() > deadline)
+					throw std::runtime_error("cannot connect to rank 0 on '" + path + "'");
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+
+			const int32_t index = rank;
+			writeAll(connections[0], &index, sizeof(index));
+		}
+	} catch (...) {
+		disconnect();
+		throw;
+	}
+}
+
+SocketTransport::~SocketTransport() {
+	disconnect();
+}
+
+// close the sockets
+void SocketTransport::disconnect() {
+	for (int& connection : connections) {
+		if (connection >= 0) {
+			close(connection);
+			connection = -1;
+		}
+	}
+
+	if (listener >= 0) {
+		close(listener);
+		unlink(path.c_str());
+		listener = -1;
+	}
+}
+
+// get the index of this rank
+int SocketTransport::getRank() const {
+	return rank;
+}
+
+// get the number of ranks
+int SocketTransport::size() const {
+	return nRanks;
+}
+
+// give the data of every rank to every rank
+void SocketTransport::allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) {
+	all.resize(nRanks);
+	all[rank] = data;
+
+	if (rank == 0) {
+		// gather the data of every rank, then send all of it to every rank
+		for (int i = 1; i < nRanks; ++i) {
+			receive(connections[i], all[i]);
+		}
+		for (int i = 1; i < nRanks; ++i) {
+			for (int k = 0; k < nRanks; ++k) {
+				send(connections[i], all[k]);
+			}
+		}
+	} else {
+		send(connections[0], data);
+		for (int k = 0; k < nRanks; ++k) {
+			receive(connections[0], all[k]);
+		}
+	}
+}
+
+// send a vector over a connection
+void SocketTransport::send(int socket, const std::vector<int32_t>& data) {
+	const uint64_t n = data.size();
+	writeAll(socket, &n, sizeof(n));
+	writeAll(socket, data.data(), n * sizeof(int32_t));
+}
+
+// receive a vector from a connection
+void SocketTransport::receive(int socket, std::vector<int32_t>& data) {
+	uint64_t n;
+	readAll(socket, &n, sizeof(n));
+	data.resize(n);
+	readAll(socket, data.data(), n * sizeof(int32_t));
+}
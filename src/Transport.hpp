@@ -0,0 +1,112 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "ThreadPool.hpp"
+
+/** \brief Exchange of data between the processes of a distributed simulation
+ *
+ * Every process, or rank, simulates a range of the neurons, and all ranks
+ * exchange their spikes once per transmission delay through a Transport.
+ * The only operation is a collective one: all ranks must call it, in the same order.
+ * Errors raise std::runtime_error.
+ * */
+class Transport {
+
+public:
+	/// Default destructor
+	virtual ~Transport() = default;
+
+	/// Get the index of this rank
+	virtual int getRank() const = 0;
+
+	/// Get the number of ranks
+	virtual int size() const = 0;
+
+	/*! \brief Give the data of every rank to every rank
+	 *
+	 * \param data		the data of this rank
+	 * \param all		receives the data of all ranks, in order of rank
+	 */
+	virtual void allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) = 0;
+};
+
+
+/** \brief Ranks running as threads of one process
+ *
+ * The ranks of a group share their data in memory, between two barriers.
+ * */
+class LocalTransport : public Transport {
+
+public:
+	/// Memory shared by the ranks of a group
+	struct Group {
+		explicit Group(int size) : data(size), barrier(size) {}
+
+		std::vector<const std::vector<int32_t>*> data;		//!< data of every rank during an exchange
+		Barrier barrier;									//!< all ranks wrote, then read their data
+	};
+
+	/// Create the transports of all ranks of a new group of \p size ranks
+	static std::vector<std::unique_ptr<LocalTransport>> createGroup(int size);
+
+	/// LocalTransport constructor, rank \p rank of \p group
+	LocalTransport(std::shared_ptr<Group> group, int rank);
+
+	virtual int getRank() const override;
+	virtual int size() const override;
+	virtual void allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) override;
+
+private:
+	std::shared_ptr<Group> group;		//!< the group of ranks
+	int rank;							//!< index of this rank
+};
+
+
+/** \brief Ranks running as processes of one machine, connected by a Unix socket
+ *
+ * Rank 0 listens on the socket and every other rank connects to it.
+ * Rank 0 receives the data of all ranks, then sends all of it to every rank.
+ * */
+class SocketTransport : public Transport {
+
+public:
+	/*! \brief SocketTransport constructor, connects all ranks
+	 *
+	 * Blocks until all ranks are connected, or the timeout expires.
+	 *
+	 * \param path		the path of the socket, created by rank 0
+	 * \param rank		index of this rank
+	 * \param size		number of ranks
+	 * \param timeout	seconds to wait for the other ranks
+	 */
+	SocketTransport(const std::string& path, int rank, int size, int timeout = 60);
+
+	/// SocketTransport destructor, closes the connections
+	virtual ~SocketTransport();
+
+	virtual int getRank() const override;
+	virtual int size() const override;
+	virtual void allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) override;
+
+private:
+	/// Send a vector over a connection
+	void send(int socket, const std::vector<int32_t>& data);
+
+	/// Receive a vector from a connection
+	void receive(int socket, std::vector<int32_t>& data);
+
+	/// Close the listening socket and the connections which are open
+	void disconnect();
+
+	std::string path;				//!< the path of the socket
+	int rank;						//!< index of this rank
+	int nRanks;						//!< number of ranks
+	int listener;					//!< listening socket of rank 0, -1 otherwise
+	std::vector<int> connections;	//!< connection to every rank from rank 0, to rank 0 from the others
+};
+
+#endif
@@ -1,32 +1,85 @@
-import numpy as np
-import pylab as pl
-
-raw_data = np.genfromtxt('spikes.gdf')
-
-select = np.array([d for d in raw_data if d[1] < 50])
-data = select.transpose()
-
-fig = pl.figure(dpi = 200)
-
-
-# Main plot
-main_scatter = fig.add_subplot(211)
-main_scatter.scatter(0.1 * data[0], data[1], alpha = 0.8, edgecolors = 'none', s = 10)
-main_scatter.set_ylabel('Neuron ID')
-#pl.xlim([100, 300])
-
-
-# Histogram
-histo = fig.add_subplot(212)
-histo.hist(0.1 * data[0], 500, normed = 0, alpha = 0.75)
-histo.set_xlabel('t [ms]')
-histo.set_ylabel('rate [Hz]')
-#pl.xlim([100, 300])
-
-
-# Export graph
-fig.savefig('spikes.png')
-
-
-# Show graph
-pl.show()
+import mmap
+import struct
+import sys
+from array import array
+
+
+def read_binary(filename, first_time = 0, last_time = None, first_neuron = 0, last_neuron = None):
+	"""Read a slice of a binary spike file (--format binary), returns (times, neurons) by window and block
+
+	Only the chunks overlapping the slice are decoded, the rest of the file is never read.
+	"""
+	with open(filename, 'rb') as f:
+		data = mmap.mmap(f.fileno(), 0, access = mmap.ACCESS_READ)
+
+	# header: magic, version, byte order, window length, block size, number of neurons
+	magic, version, byte_order, window_length, block_size, n_neurons = struct.unpack_from('=8sIIIIQ', data, 0)
+	footer, n_chunks, end, end_magic = struct.unpack_from('=QQq8s', data, len(data) - 32)
+	if magic != b'BRUNELSP' or byte_order != 0x01020304 or end_magic != b'SPKINDEX':
+		raise ValueError(filename + ' is not a complete spike file')
+
+	last_time = end if last_time is None else last_time
+	last_neuron = n_neurons if last_neuron is None else last_neuron
+
+	times, neurons = [], []
+	for i in range(n_chunks):
+		# index entry: offset, number of spikes, first step of the window, first neuron of the block
+		offset, n_spikes, window, block = struct.unpack_from('=QQqQ', data, footer + 32 * i)
+		if window >= last_time or window + window_length <= first_time:
+			continue
+		if block >= last_neuron or block + block_size <= first_neuron:
+			continue
+
+		records = array('I')
+		records.frombytes(data[offset:offset + 4 * n_spikes])
+		for record in records:
+			time, neuron = window + (record & 0xFFFF), block + (record >> 16)
+			if first_time <= time < last_time and first_neuron <= neuron < last_neuron:
+				times.append(time)
+				neurons.append(neuron)
+
+	return times, neurons
+
+
+def main():
+	import numpy as np
+	import pylab as pl
+
+	filename = sys.argv[1] if len(sys.argv) > 1 else 'spikes.gdf'
+
+	if filename.endswith('.spk'):
+		data = np.array(read_binary(filename, last_neuron = 50))
+	else:
+		raw_data = np.genfromtxt(filename)
+
+		select = np.array([d for d in raw_data if d[1] < 50])
+		data = select.transpose()
+
+	fig = pl.figure(dpi = 200)
+
+
+	# Main plot
+	main_scatter = fig.add_subplot(211)
+	main_scatter.scatter(0.1 * data[0], data[1], alpha = 0.8, edgecolors = 'none', s = 10)
+	main_scatter.set_ylabel('Neuron ID')
+	#pl.xlim([100, 300])
+
+
+	# Histogram
+	histo = fig.add_subplot(212)
+	histo.hist(0.1 * data[0], 500, normed = 0, alpha = 0.75)
+	histo.set_xlabel('t [ms]')
+	histo.set_ylabel('rate [Hz]')
+	#pl.xlim([100, 300])
+
+
+	# Export graph
+	fig.savefig('spikes.png')
+
+
+	# Show graph
+	pl.show()
+
+
+if __name__ == '__main__':
+	main()
@@ -1,33 +1,94 @@
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+#include <fstream>
+#include <memory>
 #include "Network.hpp"
 #include "Current.hpp"
-#include "Constants.hpp"
+#include "Config.hpp"
+#include "Sweep.hpp"
+#include "Transport.hpp"
 
 // note: we work with number of steps as "time unit"
-int main() {
+int main(int argc, char** argv) {
 	
-	/*
-	double currentMag = C::DEFAULT_CURRENT_MAG;
+	// read the parameters: configuration file and command line flags
+	Config config;
+	config.nThreads = std::max(1u, std::thread::hardware_concurrency());
 	
-	if (argc > 1) { // launch with command line argument if present
-		currentMag = atof(argv[1]);
+	std::vector<double> etas, gs;
+	
+	try {
+		if (!config.parse(argc, argv)) {
+			return 0;
+		}
+		config.validate();
+		
+		if (config.isSweep()) {
+			etas = config.sweepEta.empty() ? std::vector<double>(1, config.eta) : Sweep::parseGrid(config.sweepEta);
+			gs = config.sweepG.empty() ? std::vector<double>(1, config.g) : Sweep::parseGrid(config.sweepG);
+		}
+	} catch (const std::invalid_argument& error) {
+		std::cerr << "Error: " << error.what() << std::endl;
+		return 1;
+	}
+	
+	// simulate a grid of parameter points with the same connections
+	if (config.isSweep()) {
+		Sweep sweep(config, etas, gs);
+		sweep.run();
+		
+		std::ofstream summary(config.summary);
+		sweep.write(summary);
+		std::cout << "Summary saved to file '" << config.summary << "'" << std::endl;
+		
+		return 0;
 	}
-	*/
 	
-	// create current (I) object - no external current
+	// create current (I) object - no external current by default
 	Current* current = new Current(
-		0.0, 	// magnitude
-		0,		// start
-		0		// stop
+		config.current, 		// magnitude
+		config.currentStart,	// start
+		config.currentEnd		// stop
 	);
 	
+	// connect to the other processes of a distributed simulation, only the first one reports
+	std::unique_ptr<Transport> transport;
+	if (config.ranks > 1) {
+		config.verbose = config.verbose && config.rank == 0;
+		try {
+			transport.reset(new SocketTransport(config.socket, config.rank, config.ranks));
+		} catch (const std::runtime_error& error) {
+			std::cerr << "Error: " << error.what() << std::endl;
+			delete current;
+			return 1;
+		}
+	}
+	
 	// generate new network
-	Network network = Network(
-		current, 
-		10000	// length of the simulation in time steps
-	);
+	std::unique_ptr<Network> pointer(transport != nullptr ? new Network(current, config, *transport) : new Network(current, config));
+	Network& network = *pointer;
+	
+	// resume a stopped simulation
+	if (!config.restore.empty()) {
+		try {
+			network.restore(config.restore);
+		} catch (const std::runtime_error& error) {
+			std::cerr << "Error: " << error.what() << std::endl;
+			delete current;
+			return 1;
+		}
+	}
 	
 	// run the simulation
-	network.run();
+	try {
+		network.run();
+	} catch (const std::runtime_error& error) {
+		std::cerr << "Error: " << error.what() << std::endl;
+		delete current;
+		return 1;
+	}
 	
 	// save the results
 	network.save();
@@ -38,4 +99,3 @@ int main() {
 	
 	return 0;
 }
-
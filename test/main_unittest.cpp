@@ -1,8 +1,29 @@
 #include "../src/Network.hpp"
 #include "../src/Neuron.hpp"
+#include "../src/NeuronPopulation.hpp"
+#include "../src/IntegrationKernel.hpp"
+#include "../src/SynapseMatrix.hpp"
+#include "../src/ProceduralConnections.hpp"
+#include "../src/DelayRingBuffer.hpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/Philox.hpp"
+#include "../src/BackgroundNoise.hpp"
+#include "../src/PoissonSampler.hpp"
+#include "../src/NoisePipeline.hpp"
+#include "../src/SpikeRecorder.hpp"
+#include "../src/SpikeReader.hpp"
+#include "../src/Profiler.hpp"
+#include "../src/Tracer.hpp"
 #include "../src/Current.hpp"
+#include "../src/Config.hpp"
+#include "../src/Sweep.hpp"
 #include "../src/Constants.hpp"
 #include <cmath>
+#include <random>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <cstdio>
 #include "googletest/include/gtest/gtest.h"
 
 TEST(CurrentTest, CorrectOnOffTest) { 
@@ -130,6 +151,1214 @@ TEST(NeuronSpikesTest, NoSpikesOnInit) {
     EXPECT_TRUE(n.getNbSpikes() == 0);
 }
 
+TEST(NeuronPopulationTest, CorrectLayoutOnInit) {
+	NeuronPopulation population(10, 8);
+	
+	EXPECT_EQ(population.size(), 10);
+	EXPECT_EQ(population.getClock(), 0);
+	
+	// the first neurons are excitatory, the rest inhibitory
+	for (int i = 0; i < population.size(); ++i) {
+		EXPECT_EQ(population.isExcitatory(i), i < 8);
+		EXPECT_EQ(population.getTransmissionValue(i), i < 8 ? C::J_EXCITATORY : C::J_INHIBITORY);
+		EXPECT_EQ(population.getPotential(i), C::V_REST);
+		EXPECT_FALSE(population.isRefractory(i));
+		EXPECT_EQ(population.getNbSpikes(i), 0);
+	}
+}
+
+TEST(NeuronPopulationTest, CorrectSpikeAndRefractoryPeriod) {
+	NeuronPopulation population(4, 3);
+	
+	// push neuron 2 far over the threshold at the first step
+	population.receive(2, 10 * C::V_THRESHOLD, 0);
+	population.update(0.0);
+	EXPECT_GE(population.getPotential(2), C::V_THRESHOLD);
+	
+	// the neuron fires at the next step and becomes refractory
+	const std::vector<int>& spiked = population.update(0.0);
+	EXPECT_NE(std::find(spiked.begin(), spiked.end(), 2), spiked.end());
+	EXPECT_TRUE(population.isRefractory(2));
+	EXPECT_EQ(population.getSpikeTimes(2).back(), 1);
+	
+	// it stays at rest during its refractory period, this step included
+	for (int i = 2; i < C::REFRACTORY_TIME; ++i) {
+		population.update(0.0);
+		EXPECT_TRUE(population.isRefractory(2));
+		EXPECT_EQ(population.getPotential(2), C::V_REST);
+	}
+	
+	population.update(0.0);
+	EXPECT_FALSE(population.isRefractory(2));
+}
+
+TEST(IntegrationKernelTest, SameResultOnEveryInstructionSet) {
+	const Kernel::Parameters params = { 0.995, 0.01, C::V_THRESHOLD, C::V_REST, C::REFRACTORY_TIME };
+	const int size = 1003;
+	
+	// random potentials around the threshold, some neurons refractory
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<double> potentialDistr(0.0, 1.5 * C::V_THRESHOLD);
+	std::uniform_int_distribution<int> refractoryDistr(-C::REFRACTORY_TIME, C::REFRACTORY_TIME);
+	
+	std::vector<double> potentials(size), input(size);
+	std::vector<int> refractory(size);
+	for (int i = 0; i < size; ++i) {
+		potentials[i] = potentialDistr(gen);
+		input[i] = 0.1 * potentialDistr(gen);
+		refractory[i] = std::max(0, refractoryDistr(gen));
+	}
+	
+	// reference: scalar kernel, on an unaligned range
+	std::vector<double> refPotentials(potentials), refInput(input);
+	std::vector<int> refRefractory(refractory), refSpikes(size);
+	int nRefSpikes = Kernel::integrate(Kernel::SimdLevel::Scalar, params, 1, size,
+									   refPotentials.data(), refRefractory.data(), refInput.data(), refSpikes.data());
+	refSpikes.resize(nRefSpikes);
+	EXPECT_GT(nRefSpikes, 0);
+	
+	for (auto level : { Kernel::SimdLevel::SSE2, Kernel::SimdLevel::AVX2, Kernel::SimdLevel::AVX512 }) {
+		if (level > Kernel::getSupportedLevel())
+			continue;
+		
+		std::vector<double> p(potentials), in(input);
+		std::vector<int> r(refractory), spikes(size);
+		int nSpikes = Kernel::integrate(level, params, 1, size, p.data(), r.data(), in.data(), spikes.data());
+		spikes.resize(nSpikes);
+		
+		EXPECT_EQ(spikes, refSpikes) << Kernel::getName(level);
+		EXPECT_EQ(p, refPotentials) << Kernel::getName(level);
+		EXPECT_EQ(r, refRefractory) << Kernel::getName(level);
+		EXPECT_EQ(in, refInput) << Kernel::getName(level);
+	}
+}
+
+TEST(SynapseMatrixTest, CorrectTargets) {
+	// sources of neurons 0, 1, 2 and 3, two each
+	std::vector<int> sources = { 1, 2,  3, 3,  0, 1,  1, 2 };
+	ThreadPool pool(1);
+	SynapseMatrix synapses(4, 2, sources, pool);
+	
+	EXPECT_EQ(synapses.size(), 4);
+	EXPECT_EQ(synapses.getNbSynapses(), sources.size());
+	
+	// targets are grouped by source, in increasing order
+	std::vector<std::vector<int>> expected = { { 2 }, { 0, 2, 3 }, { 0, 3 }, { 1, 1 } };
+	for (int source = 0; source < synapses.size(); ++source) {
+		EXPECT_EQ(synapses.getTargets(source), expected[source]);
+		EXPECT_EQ(synapses.getNbTargets(source), expected[source].size());
+	}
+}
+
+TEST(SynapseMatrixTest, TargetsAcrossPages) {
+	// targets in three pages, the sources of every neuron are its neighbours
+	const int size = 2 * SynapseMatrix::PAGE_SIZE + 100;
+	std::vector<int> sources;
+	for (int target = 0; target < size; ++target) {
+		sources.push_back((target + 1) % size);
+		sources.push_back((target + size - 1) % size);
+	}
+	
+	ThreadPool pool(3);
+	SynapseMatrix synapses(size, 2, sources, pool);
+	EXPECT_EQ(synapses.getNbPages(), 3);
+	
+	for (int source : { 0, 1, SynapseMatrix::PAGE_SIZE, SynapseMatrix::PAGE_SIZE + 1, size - 1 }) {
+		std::vector<int> expected = { (source + size - 1) % size, (source + 1) % size };
+		std::sort(expected.begin(), expected.end());
+		EXPECT_EQ(synapses.getTargets(source), expected);
+		
+		// only the targets within the range
+		std::vector<int> inRange;
+		synapses.forEachTarget(source, source, std::min(source + 2, size), [&](int target) { inRange.push_back(target); });
+		EXPECT_EQ(inRange, source + 1 < size ? std::vector<int>(1, source + 1) : std::vector<int>()) << source;
+	}
+}
+
+TEST(SynapseMatrixTest, SameTargetsOnAnyNumberOfThreads) {
+	std::mt19937 engine(5);
+	std::uniform_int_distribution<int> distr(0, 99);
+	std::vector<int> sources(100 * 7);
+	for (int& source : sources) {
+		source = distr(engine);
+	}
+	
+	ThreadPool one(1);
+	SynapseMatrix serial(100, 7, sources, one);
+	
+	for (int nThreads : { 1, 2, 3, 8 }) {
+		ThreadPool pool(nThreads);
+		SynapseMatrix parallel(100, 7, sources, pool);
+		
+		ASSERT_EQ(parallel.getNbSynapses(), serial.getNbSynapses());
+		for (int source = 0; source < 100; ++source) {
+			auto expected = serial.getTargets(source), actual = parallel.getTargets(source);
+			EXPECT_EQ(actual, expected);
+		}
+	}
+}
+
+TEST(SynapseMatrixTest, CacheMappedOnlyWithSameParameters) {
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.verbose = false;
+	config.connectionCache = "connections_test.bin";
+	std::remove(config.connectionCache.c_str());
+	
+	// drawn and saved, then mapped
+	auto built = Network::createSynapses(config);
+	auto mapped = Network::createSynapses(config);
+	EXPECT_FALSE(built->isMapped());
+	EXPECT_TRUE(mapped->isMapped());
+	
+	ASSERT_EQ(mapped->size(), built->size());
+	ASSERT_EQ(mapped->getNbSynapses(), built->getNbSynapses());
+	for (int source = 0; source < built->size(); ++source) {
+		auto expected = built->getTargets(source), actual = mapped->getTargets(source);
+		EXPECT_EQ(actual, expected);
+	}
+	
+	// any change of the connections' parameters invalidates the cache
+	for (int change = 0; change < 3; ++change) {
+		Config other = config;
+		if (change == 0) other.nExcitatory = 900;
+		if (change == 1) other.epsilon = 0.2;
+		if (change == 2) other.seed += 1;
+		
+		EXPECT_NE(other.getConnectionsHash(), config.getConnectionsHash());
+		EXPECT_EQ(SynapseMatrix::load(config.connectionCache, other.getConnectionsHash()), nullptr);
+	}
+	
+	// parameters of the dynamics do not
+	Config dynamics = config;
+	dynamics.eta = 0.9;
+	dynamics.g = 4.5;
+	EXPECT_EQ(dynamics.getConnectionsHash(), config.getConnectionsHash());
+	
+	// nor is a file whose offsets point outside the targets
+	{
+		std::fstream file(config.connectionCache, std::ios::binary | std::ios::in | std::ios::out);
+		const uint64_t offset = built->getNbSynapses() + 1;
+		file.seekp(64 + sizeof(uint64_t));
+		file.write((const char*) &offset, sizeof(offset));
+	}
+	EXPECT_EQ(SynapseMatrix::load(config.connectionCache, config.getConnectionsHash()), nullptr);
+	
+	std::remove(config.connectionCache.c_str());
+}
+
+TEST(ProceduralConnectionsTest, SameTargetsInAnyRange) {
+	const int size = 2500;
+	ProceduralConnections connections(size, 0.1, 7);
+	std::vector<int> inDegrees(size, 0);
+	long nSynapses = 0;
+	
+	for (int source = 0; source < size; ++source) {
+		std::vector<int> targets = connections.getTargets(source);
+		nSynapses += targets.size();
+		ASSERT_EQ(connections.getNbTargets(source), (int) targets.size());
+		
+		// the targets of split ranges are the targets of the whole range
+		std::vector<int> split;
+		for (int first : { 0, 1000, 1003, 2048 }) {
+			int last = first == 0 ? 1000 : first == 1000 ? 1003 : first == 1003 ? 2048 : size;
+			connections.forEachTarget(source, first, last, [&](int target) {
+				EXPECT_TRUE(first <= target && target < last);
+				split.push_back(target);
+			});
+		}
+		std::sort(split.begin(), split.end());
+		std::vector<int> sorted(targets);
+		std::sort(sorted.begin(), sorted.end());
+		EXPECT_EQ(split, sorted);
+		
+		for (int target : targets) {
+			ASSERT_TRUE(0 <= target && target < size);
+			++inDegrees[target];
+		}
+	}
+	
+	// epsilon of all pairs are connected, evenly over the targets
+	EXPECT_NEAR(nSynapses / (double) size, 0.1 * size, 1.0);
+	EXPECT_NEAR(*std::max_element(inDegrees.begin(), inDegrees.end()), 0.1 * size, 0.1 * size * 0.3);
+	EXPECT_EQ(ProceduralConnections(size, 0.1, 7).getTargets(3), connections.getTargets(3));
+	EXPECT_NE(ProceduralConnections(size, 0.1, 8).getTargets(3), connections.getTargets(3));
+}
+
+TEST(DelayRingBufferTest, CorrectSlots) {
+	DelayRingBuffer buffer(10, C::TRANSMISSION_BUFFER_SIZE);
+	
+	// rows start on a cache line
+	for (long t = 0; t < buffer.getNbSlots(); ++t) {
+		EXPECT_EQ((std::size_t) buffer.getRow(t) % 64, 0u);
+	}
+	
+	// arrival times one revolution apart share their row
+	buffer.add(3, C::J_EXCITATORY, C::TRANSMISSION_DELAY);
+	EXPECT_EQ(buffer.getRow(C::TRANSMISSION_DELAY + C::TRANSMISSION_BUFFER_SIZE)[3], C::J_EXCITATORY);
+	EXPECT_EQ(buffer.getRow(C::TRANSMISSION_DELAY - 1)[3], 0.0);
+}
+
+TEST(ThreadPoolTest, CorrectPhases) {
+	ThreadPool pool(4);
+	EXPECT_EQ(pool.size(), 4);
+	
+	std::vector<int> written(pool.size(), 0), read(pool.size(), 0);
+	
+	for (int repeat = 0; repeat < 100; ++repeat) {
+		pool.run([&](int thread) {
+			// every thread writes its own value...
+			written[thread] = repeat + thread;
+			pool.sync();
+			
+			// ...and sees the values of all others after the barrier
+			read[thread] = 0;
+			for (int value : written) {
+				read[thread] += value;
+			}
+		});
+		
+		for (int sum : read) {
+			EXPECT_EQ(sum, 4 * repeat + 6);
+		}
+	}
+}
+
+TEST(PhiloxTest, KnownAnswers) {
+	// reference values from the Random123 distribution
+	Philox::Block zero = Philox(0)(0, 0, 0, 0);
+	EXPECT_EQ(zero.v[0], 0x6627e8d5u);
+	EXPECT_EQ(zero.v[1], 0xe169c58du);
+	EXPECT_EQ(zero.v[2], 0xbc57ac4cu);
+	EXPECT_EQ(zero.v[3], 0x9b00dbd8u);
+	
+	Philox::Block pi = Philox(0x299f31d0a4093822ull)(0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344);
+	EXPECT_EQ(pi.v[0], 0xd16cfe09u);
+	EXPECT_EQ(pi.v[1], 0x94fdccebu);
+	EXPECT_EQ(pi.v[2], 0x5001e420u);
+	EXPECT_EQ(pi.v[3], 0x24126ea1u);
+}
+
+TEST(BackgroundNoiseTest, ReproducibleAndPoissonDistributed) {
+	const double lambda = C::V_EXT * C::STEP_DURATION;
+	BackgroundNoise noise(7), same(7), other(8);
+	
+	const int nSamples = 100000;
+	double sum = 0.0, sumSquares = 0.0;
+	int nDifferent = 0;
+	
+	for (int i = 0; i < nSamples; ++i) {
+		int k = noise.getNbSpikes(i % 100, i / 100);
+		EXPECT_EQ(k, same.getNbSpikes(i % 100, i / 100));
+		nDifferent += k != other.getNbSpikes(i % 100, i / 100);
+		
+		sum += k;
+		sumSquares += k * k;
+	}
+	
+	// another seed gives another stream
+	EXPECT_GT(nDifferent, nSamples / 2);
+	
+	// mean and variance of a Poisson distribution are both lambda
+	double mean = sum / nSamples;
+	EXPECT_NEAR(mean, lambda, 0.02 * lambda);
+	EXPECT_NEAR(sumSquares / nSamples - mean * mean, lambda, 0.05 * lambda);
+	
+	// the batch version adds the same values
+	std::vector<double> input(10, 1.0);
+	noise.add(2, 8, 42, input.data());
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_EQ(input[i], 1.0 + (2 <= i && i < 8 ? noise.get(i, 42) : 0.0));
+	}
+}
+
+TEST(PoissonSamplerTest, MatchesDistribution) {
+	for (double lambda : { 0.5, 2.0, 4.0 }) {
+		PoissonSampler sampler(lambda);
+		EXPECT_EQ(sampler.getLambda(), lambda);
+		
+		// the smallest word always gives 0, the largest one lands in the far tail
+		EXPECT_EQ(sampler(0, 0), 0);
+		EXPECT_GT(sampler(0xFFFFFFFF, 0xFFFFFFFF), 2 * lambda + 5);
+		
+		// evenly spread words reproduce the probabilities of the distribution
+		const int nSamples = 1 << 20;
+		std::vector<int> histogram(64, 0);
+		for (int i = 0; i < nSamples; ++i) {
+			++histogram[sampler((uint32_t) i << 12, 0)];
+		}
+		
+		double p = exp(-lambda);
+		for (int k = 0; k < 10; ++k) {
+			EXPECT_NEAR(histogram[k] / (double) nSamples, p, 1e-5) << "lambda " << lambda << ", k " << k;
+			p *= lambda / (k + 1);
+		}
+	}
+}
+
+TEST(NoisePipelineTest, SameNoiseInlineAndProduced) {
+	BackgroundNoise noise(3);
+	NoisePipeline inlined(noise, 100, C::TRANSMISSION_DELAY), produced(noise, 100, C::TRANSMISSION_DELAY);
+	produced.startProducer();
+	EXPECT_TRUE(produced.hasProducer());
+	
+	// the noise of a range only, its rows start at its first neuron
+	NoisePipeline range(noise, 30, 70, C::TRANSMISSION_DELAY);
+	range.startProducer();
+	
+	// a short epoch, then a full one in the other buffer
+	for (long epoch : { 5L, (long) C::TRANSMISSION_DELAY }) {
+		int nSteps = C::TRANSMISSION_DELAY - epoch % C::TRANSMISSION_DELAY;
+		
+		inlined.generate(0, 40, epoch, nSteps);
+		inlined.generate(40, 100, epoch, nSteps);
+		produced.request(epoch, nSteps);
+		produced.wait(epoch);
+		range.request(epoch, nSteps);
+		range.wait(epoch);
+		
+		for (long time = epoch; time < epoch + nSteps; ++time) {
+			for (int i = 0; i < 100; ++i) {
+				EXPECT_EQ(inlined.getRow(time)[i], noise.get(i, time));
+				EXPECT_EQ(produced.getRow(time)[i], noise.get(i, time));
+			}
+			for (int i = 30; i < 70; ++i) {
+				EXPECT_EQ(range.getRow(time)[i - 30], noise.get(i, time));
+			}
+		}
+	}
+}
+
+TEST(SpikeRecorderTest, SameFileOnAnyNumberOfThreads) {
+	// neuron i spikes at steps multiple of i + 1
+	auto record = [](int nThreads, const std::string& filename) {
+		SpikeRecorder recorder(std::unique_ptr<SpikeWriter>(new TextSpikeWriter(filename)), nThreads, 4, 3);
+		ThreadPool pool(nThreads);
+		
+		pool.run([&](int thread) {
+			const int first = 12 * thread / nThreads, last = 12 * (thread + 1) / nThreads;
+			for (long epoch = 0; epoch < 60; epoch += 15) {
+				for (long time = epoch; time < epoch + 15; ++time) {
+					for (int i = first; i < last; ++i) {
+						if (time % (i + 1) == 0) {
+							recorder.record(thread, time, i);
+						}
+					}
+				}
+				recorder.advance(thread, epoch + 15);
+			}
+		});
+		
+		recorder.finish();
+		
+		std::ifstream in(filename);
+		std::stringstream text;
+		text << in.rdbuf();
+		std::remove(filename.c_str());
+		return text.str();
+	};
+	
+	std::string expected;
+	for (long time = 0; time < 60; ++time) {
+		for (int i = 0; i < 12; ++i) {
+			if (time % (i + 1) == 0) {
+				expected += std::to_string(time) + "\t" + std::to_string(i) + "\n";
+			}
+		}
+	}
+	
+	EXPECT_EQ(record(1, "recorder_test1.gdf"), expected);
+	EXPECT_EQ(record(3, "recorder_test3.gdf"), expected);
+}
+
+TEST(SpikeWriterTest, SameTextOnAnyNumberOfThreads) {
+	// numbers of every length, in batches small and large
+	std::vector<Spike> spikes;
+	std::string expected;
+	for (int i = 0; i < 100000; ++i) {
+		const long time = i % 7 == 0 ? 9223372036854775807L / (i + 1) : i * 13L;
+		const int neuron = i % 3 == 0 ? 0 : i % 2147483647;
+		spikes.push_back({ time, neuron });
+		expected += std::to_string(time) + "\t" + std::to_string(neuron) + "\n";
+	}
+	
+	auto write = [&](int nThreads, const std::string& filename) {
+		TextSpikeWriter writer(filename, nThreads);
+		writer.write(spikes.data(), 10);
+		writer.write(spikes.data() + 10, spikes.size() - 10);
+		writer.close(0);
+		
+		std::ifstream in(filename);
+		std::stringstream text;
+		text << in.rdbuf();
+		std::remove(filename.c_str());
+		return text.str();
+	};
+	
+	EXPECT_EQ(write(1, "writer_test1.gdf"), expected);
+	EXPECT_EQ(write(3, "writer_test3.gdf"), expected);
+}
+
+TEST(SpikeReaderTest, ReadsSlicesOfBinaryFiles) {
+	// spikes over several windows and blocks
+	const int nNeurons = BinarySpikeWriter::BLOCK_SIZE + 100;
+	const long end = 2 * BinarySpikeWriter::WINDOW_LENGTH + 500;
+	std::vector<Spike> spikes;
+	for (long time = 0; time < end; ++time) {
+		for (int i = 0; i < nNeurons; i += 37) {
+			if (time % (i % 50 + 1) == 0) {
+				spikes.push_back({ time, i });
+			}
+		}
+	}
+	
+	{
+		auto output = SpikeWriter::open("reader_test.spk", "binary", nNeurons);
+		ASSERT_TRUE(output->isOpen());
+		output->write(spikes.data(), spikes.size() / 2);
+		output->write(spikes.data() + spikes.size() / 2, spikes.size() - spikes.size() / 2);
+		output->close(end);
+	}
+	
+	SpikeReader reader("reader_test.spk");
+	EXPECT_EQ(reader.getNbNeurons(), nNeurons);
+	EXPECT_EQ(reader.getEnd(), end);
+	EXPECT_EQ(reader.getNbSpikes(), spikes.size());
+	
+	auto isSame = [](const std::vector<Spike>& a, const std::vector<Spike>& b) {
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+			[](const Spike& x, const Spike& y) { return x.time == y.time && x.neuron == y.neuron; });
+	};
+	EXPECT_TRUE(isSame(reader.read(), spikes));
+	
+	// a slice across windows and blocks
+	std::vector<Spike> slice;
+	for (const Spike& spike : spikes) {
+		if (900 <= spike.time && spike.time < 2100 && 4000 <= spike.neuron && spike.neuron < 4150) {
+			slice.push_back(spike);
+		}
+	}
+	EXPECT_FALSE(slice.empty());
+	EXPECT_TRUE(isSame(reader.read(900, 2100, 4000, 4150), slice));
+	
+	// continued at the end of a window, a file has the same bytes, with one index
+	std::ifstream in("reader_test.spk", std::ios::binary);
+	std::stringstream whole;
+	whole << in.rdbuf();
+	in.close();
+	
+	const long split = BinarySpikeWriter::WINDOW_LENGTH;
+	const std::size_t first = std::lower_bound(spikes.begin(), spikes.end(), split,
+		[](const Spike& spike, long time) { return spike.time < time; }) - spikes.begin();
+	{
+		auto output = SpikeWriter::open("reader_test.spk", "binary", nNeurons);
+		output->write(spikes.data(), first);
+		output->close(split);
+	}
+	{
+		auto output = SpikeWriter::open("reader_test.spk", "binary", nNeurons, 1, true);
+		output->write(spikes.data() + first, spikes.size() - first);
+		output->close(end);
+	}
+	in.open("reader_test.spk", std::ios::binary);
+	std::stringstream continued;
+	continued << in.rdbuf();
+	in.close();
+	EXPECT_TRUE(continued.str() == whole.str());
+	
+	// a chunk past the end of the spikes is refused
+	{
+		std::fstream file("reader_test.spk", std::ios::binary | std::ios::in | std::ios::out);
+		SpikeFormat::Trailer trailer;
+		file.seekg(-(long) sizeof(trailer), std::ios::end);
+		file.read((char*) &trailer, sizeof(trailer));
+		const uint64_t nSpikes = spikes.size() + 1;
+		file.seekp(trailer.footer + offsetof(SpikeFormat::Entry, nSpikes));
+		file.write((const char*) &nSpikes, sizeof(nSpikes));
+	}
+	EXPECT_THROW(SpikeReader("reader_test.spk"), std::runtime_error);
+	
+	std::remove("reader_test.spk");
+	EXPECT_THROW(SpikeReader("reader_test.spk"), std::runtime_error);
+}
+
+TEST(PopulationStatisticsTest, SameAsFromAllSpikes) {
+	// 6 excitatory and 2 inhibitory neurons on 2 threads, neuron i spikes at steps multiple of i + 2, and at 7
+	const long end = 95;
+	PopulationStatistics statistics(6, 2, 2, 10, 0.1E-3, end);
+	std::vector<std::vector<long>> times(8);
+	
+	for (long time = 0; time < end; ++time) {
+		for (int i = 0; i < 8; ++i) {
+			if (time % (i + 2) == 0 || time == 7) {
+				statistics.record(i < 4 ? 0 : 1, time, i);
+				times[i].push_back(time);
+			}
+		}
+	}
+	statistics.finish(end);
+	
+	// bins of 10 steps, the last one of 5
+	ASSERT_EQ(statistics.getNbBins(), 10u);
+	std::vector<double> counts(10, 0.0);
+	long nExcitatory = 0;
+	for (int i = 0; i < 8; ++i) {
+		for (long time : times[i]) {
+			++counts[time / 10];
+		}
+		nExcitatory += i < 6 ? times[i].size() : 0;
+	}
+	
+	EXPECT_EQ(statistics.getNbSpikes(PopulationStatistics::EXCITATORY), nExcitatory);
+	EXPECT_DOUBLE_EQ(statistics.getRate(), statistics.getNbSpikes() / (8 * end * 0.1E-3));
+	EXPECT_DOUBLE_EQ(statistics.getRates()[9], counts[9] / (8 * 5 * 0.1E-3));
+	
+	double mean = 0.0, variance = 0.0;
+	for (double count : counts) mean += count / 10;
+	for (double count : counts) variance += (count - mean) * (count - mean) / 10;
+	EXPECT_NEAR(statistics.getCountVariance(), variance, 1E-9);
+	EXPECT_NEAR(statistics.getFanoFactor(), variance / mean, 1E-9);
+	
+	// intervals of every neuron, in two passes
+	for (int i = 0; i < 8; ++i) {
+		std::vector<double> intervals;
+		for (std::size_t k = 1; k < times[i].size(); ++k) {
+			intervals.push_back(times[i][k] - times[i][k - 1]);
+		}
+		
+		double isiMean = 0.0, isiVariance = 0.0;
+		for (double interval : intervals) isiMean += interval / intervals.size();
+		for (double interval : intervals) isiVariance += (interval - isiMean) * (interval - isiMean) / intervals.size();
+		
+		EXPECT_EQ(statistics.getNbSpikes(i), (long) times[i].size());
+		EXPECT_NEAR(statistics.getIsiMean(i), isiMean, 1E-9);
+		EXPECT_NEAR(statistics.getIsiCv(i), std::sqrt(isiVariance) / isiMean, 1E-9);
+	}
+}
+
+TEST(ProfilerTest, ChargesEveryLapToItsPhase) {
+	// the same epochs with and without the timeline
+	Profiler profiler(2), withTimeline(2, true);
+	
+	for (Profiler* p : { &profiler, &withTimeline }) {
+		for (long epoch = 0; epoch < 30; epoch += 15) {
+			for (int thread = 0; thread < 2; ++thread) {
+				p->start(thread);
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				p->lap(thread, Profiler::INTEGRATE);
+				p->lap(thread, Profiler::DELIVER);
+				p->count(thread, 1500, 3, 300);
+				p->endEpoch(thread, epoch, epoch + 15);
+			}
+		}
+	}
+	const Profiler::Clock::time_point now = Profiler::Clock::now();
+	profiler.add(Profiler::OUTPUT, now, now + std::chrono::milliseconds(5));
+	
+	EXPECT_TRUE(profiler.getEpochs(1).empty());
+	ASSERT_EQ(withTimeline.getEpochs(1).size(), 2u);
+	EXPECT_EQ(withTimeline.getEpochs(1)[1].start, 15);
+	EXPECT_EQ(withTimeline.getEpochs(1)[1].nEvents, 300);
+	EXPECT_EQ(withTimeline.getNbEvents(), profiler.getNbEvents());
+	EXPECT_GE(profiler.getTime(Profiler::INTEGRATE, 0), 0.004);
+	EXPECT_LT(profiler.getTime(Profiler::DELIVER, 0), profiler.getTime(Profiler::INTEGRATE, 0));
+	EXPECT_EQ(profiler.getTime(Profiler::NOISE, 1), 0.0);
+	EXPECT_DOUBLE_EQ(profiler.getTime(Profiler::OUTPUT), 0.005);
+	EXPECT_EQ(profiler.getNbSteps(), 30);
+	EXPECT_EQ(profiler.getNbSpikes(), 12);
+	EXPECT_EQ(profiler.getNbEvents(), 1200);
+	
+	// a table of phases, sections and counts, then one line per epoch and thread
+	std::ostringstream summary, timeline;
+	profiler.write(summary);
+	withTimeline.write(timeline);
+	const std::string table = summary.str(), lines = timeline.str();
+	EXPECT_EQ(table.find("# phase\tthread_0\tthread_1\ttotal\tshare\nnoise\t"), 0u);
+	EXPECT_NE(table.find("# steps\tspikes\tsynaptic_events\tspikes_per_step\tevents_per_step\n30\t12\t1200\t0.4\t40\n"), std::string::npos);
+	EXPECT_NE(lines.find("# steps\tspikes\tsynaptic_events\tspikes_per_step\tevents_per_step\n30\t12\t1200\t0.4\t40\n# start\tend\tthread\t"), std::string::npos);
+	EXPECT_EQ(std::count(lines.begin(), lines.end(), '\n') - std::count(table.begin(), table.end(), '\n'), 1 + 4);
+	
+	EXPECT_EQ(profiler.getNbUpdates(), 4 * 1500);
+	EXPECT_EQ(table.find("# phase_counters"), std::string::npos);
+	
+	// the hardware counters count, or tell why they do not
+	PerfCounters counters;
+	PerfCounters::Values before, after;
+	counters.read(before);
+	volatile double sum = 0.0;
+	for (int i = 0; i < 100000; ++i) {
+		sum = sum + i;
+	}
+	counters.read(after);
+	
+	for (int event = 0; event < PerfCounters::N_EVENTS; ++event) {
+		if (!counters.has((PerfCounters::Event) event)) {
+			EXPECT_FALSE(counters.getError().empty());
+			EXPECT_EQ(after[event], 0u);
+		}
+	}
+	if (counters.has(PerfCounters::INSTRUCTIONS)) {
+		EXPECT_GT(after[PerfCounters::INSTRUCTIONS] - before[PerfCounters::INSTRUCTIONS], 100000u);
+	}
+	
+	Profiler counted(1, false, true);
+	counted.start(0);
+	counted.lap(0, Profiler::DELIVER);
+	counted.count(0, 10, 1, 100);
+	counted.endEpoch(0, 0, 10);
+	std::ostringstream withCounters;
+	counted.write(withCounters);
+	EXPECT_NE(withCounters.str().find("# phase_counters\tcycles\tinstructions\tllc_misses\tbranch_misses\tipc\n"), std::string::npos);
+	EXPECT_EQ(counted.hasCount(PerfCounters::CYCLES), counters.has(PerfCounters::CYCLES));
+	EXPECT_EQ(counted.getCountersError(), counters.getError());
+	
+	// a profiled network counts every spike and synaptic event
+	if (Profiler::ENABLED) {
+		Config config;
+		config.nExcitatory = 800;
+		config.nInhibitory = 200;
+		config.backgroundNoise = true;
+		config.duration = 300;
+		config.nThreads = 2;
+		config.verbose = false;
+		config.streamSpikes = false;
+		config.profile = "profiler_test.txt";
+		config.profileCounters = true;
+		config.trace = "tracer_test.json";
+		
+		Current current(0.0, 0, 0);
+		Network network(&current, config);
+		network.run();
+		
+		std::ifstream in(config.profile);
+		std::string header;
+		EXPECT_TRUE(std::getline(in, header) && header.find("# phase") == 0);
+		std::remove(config.profile.c_str());
+		
+		std::ifstream trace(config.trace);
+		EXPECT_TRUE(std::getline(trace, header) && header.find("{\"displayTimeUnit\"") == 0);
+		
+		// the trace starts with drawing the connections
+		std::stringstream events;
+		events << trace.rdbuf();
+		const std::size_t connections = events.str().find("{\"name\": \"connections\"");
+		ASSERT_NE(connections, std::string::npos);
+		EXPECT_EQ(events.str().find("\"ts\": -"), std::string::npos);
+		const std::string event = events.str().substr(connections, events.str().find('\n', connections) - connections);
+		EXPECT_NE(event.find("\"ts\": 0.000,"), std::string::npos) << event;
+		std::remove(config.trace.c_str());
+	}
+}
+
+TEST(TracerTest, WritesEveryTrackOfEveryThread) {
+	Tracer tracer(3);
+	Profiler profiler(2, false, false, &tracer);
+	const int writerTrack = tracer.addTrack("spike writer");
+	ASSERT_EQ(tracer.size(), 3);
+	
+	// every thread only adds to its own track
+	std::thread worker([&]() {
+		profiler.start(1);
+		profiler.lap(1, Profiler::INTEGRATE);
+		profiler.count(1, 10, 2, 20);
+		profiler.endEpoch(1, 0, 15);
+	});
+	profiler.start(0);
+	profiler.lap(0, Profiler::NOISE);
+	profiler.lap(0, Profiler::DELIVER);
+	profiler.endEpoch(0, 0, 15);
+	worker.join();
+	
+	ASSERT_EQ(tracer.getEvents(0).size(), 3u);
+	EXPECT_STREQ(tracer.getEvents(0)[1].name, "deliver");
+	EXPECT_EQ(tracer.getEvents(0)[2].begin, tracer.getEvents(0)[0].begin);
+	EXPECT_EQ(tracer.getEvents(0)[2].end, tracer.getEvents(0)[1].end);
+	ASSERT_EQ(tracer.getEvents(1).size(), 2u);
+	EXPECT_EQ(tracer.getEvents(1)[1].count, 2);
+	
+	// the writes of the spikes, with their first step and number
+	std::vector<Spike> spikes = { { 4, 1 }, { 5, 0 } };
+	TracedSpikeWriter writer(SpikeWriter::open("tracer_test.gdf", "gdf", 2), tracer, writerTrack);
+	EXPECT_TRUE(writer.isOpen());
+	writer.write(spikes.data(), 2);
+	writer.write(spikes.data(), 0);
+	writer.close(6);
+	std::ifstream in("tracer_test.gdf");
+	std::stringstream text;
+	text << in.rdbuf();
+	std::remove("tracer_test.gdf");
+	EXPECT_EQ(text.str(), "4\t1\n5\t0\n");
+	ASSERT_EQ(tracer.getEvents(writerTrack).size(), 2u);
+	EXPECT_EQ(tracer.getEvents(writerTrack)[0].step, 4);
+	EXPECT_EQ(tracer.getEvents(writerTrack)[0].count, 2);
+	
+	// names of the threads, then complete events
+	std::ostringstream out;
+	tracer.write(out);
+	const std::string json = out.str();
+	EXPECT_EQ(json.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"), 0u);
+	EXPECT_NE(json.find("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 3, \"tid\": 2, \"args\": {\"name\": \"spike writer\"}}"), std::string::npos);
+	EXPECT_NE(json.find("\"args\": {\"step\": 0, \"spikes\": 2}}"), std::string::npos);
+	EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+	
+	long nEvents = 0;
+	for (std::size_t i = json.find("\"ph\": \"X\""); i != std::string::npos; i = json.find("\"ph\": \"X\"", i + 1)) {
+		++nEvents;
+	}
+	EXPECT_EQ(nEvents, 3 + 2 + 2);
+	EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+}
+
+TEST(ConfigTest, ParseWriteAndLoad) {
+	Config config;
+	const char* argv[] = { "NeuroSimulation", "--eta=0.9", "--g", "4.5", "--n_excitatory=800", "--background_noise=false" };
+	EXPECT_TRUE(config.parse(6, const_cast<char**>(argv)));
+	
+	EXPECT_EQ(config.eta, 0.9);
+	EXPECT_EQ(config.g, 4.5);
+	EXPECT_EQ(config.getNbNeurons(), 800 + C::N_INHIBITORY);
+	EXPECT_FALSE(config.backgroundNoise);
+	EXPECT_EQ(config.getJInhibitory(), -4.5 * C::J_EXCITATORY);
+	EXPECT_EQ(config.getOutput(), "../results/spikes_eta0.9_g4.5.gdf");
+	
+	// writing then loading gives back the same parameters
+	{
+		std::ofstream out("config_test.cfg");
+		out << "# written by the test" << std::endl;
+		config.write(out);
+	}
+	Config loaded;
+	loaded.load("config_test.cfg");
+	std::remove("config_test.cfg");
+	std::ostringstream expected, actual;
+	config.write(expected);
+	loaded.write(actual);
+	EXPECT_EQ(actual.str(), expected.str());
+	
+	EXPECT_THROW(config.set("unknown", "1"), std::invalid_argument);
+	EXPECT_THROW(config.set("eta", "two"), std::invalid_argument);
+	
+	config.delay = 0;
+	EXPECT_THROW(config.validate(), std::invalid_argument);
+	
+	// the physical parameters give a finite, non-negative external rate
+	for (const char* flag : { "eta=-1", "j=0", "j=-0.1", "tau=0", "tau=-0.02", "step_duration=0", "step_duration=-1e-4",
+							  "threshold=-20", "tau=1e-320" }) {
+		Config physical;
+		const std::string assignment = flag;
+		physical.set(assignment.substr(0, assignment.find('=')), assignment.substr(assignment.find('=') + 1));
+		EXPECT_THROW(physical.validate(), std::invalid_argument) << flag;
+	}
+	Config silent;
+	silent.eta = 0.0;
+	EXPECT_NO_THROW(silent.validate());
+	
+	// the points of a sweep would all write, or restore, the same checkpoint
+	Config sweep;
+	sweep.sweepG = "3,5";
+	sweep.checkpoint = "sweep_test.ckpt";
+	EXPECT_THROW(sweep.validate(), std::invalid_argument);
+	sweep.checkpoint = "";
+	sweep.restore = "sweep_test.ckpt";
+	EXPECT_THROW(sweep.validate(), std::invalid_argument);
+}
+
+TEST(NetworkTest, RunsWithConfiguredParameters) {
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.backgroundNoise = true;
+	config.delay = 3;
+	config.duration = 300;
+	config.nThreads = 2;
+	config.verbose = false;
+	config.output = "network_test.gdf";
+	
+	Current current(0.0, 0, 0);
+	Network network(&current, config);
+	
+	EXPECT_EQ(network.getPopulation().size(), 1000);
+	EXPECT_EQ(network.getSynapses().getNbSynapses(), (std::size_t) 1000 * (80 + 20));
+	
+	network.run();
+	
+	EXPECT_EQ(network.getPopulation().getClock(), 300);
+	
+	long nSpikes = 0;
+	for (int i = 0; i < network.getPopulation().size(); ++i) {
+		nSpikes += network.getPopulation().getNbSpikes(i);
+		EXPECT_TRUE(network.getPopulation().getSpikeTimes(i).empty());
+	}
+	EXPECT_GT(nSpikes, 0);
+	
+	// the spikes were streamed to the file, in order of time then neuron
+	std::ifstream in(config.output);
+	long time, neuron, previousTime = -1, previousNeuron = -1, nLines = 0;
+	while (in >> time >> neuron) {
+		EXPECT_TRUE(time > previousTime || (time == previousTime && neuron > previousNeuron));
+		EXPECT_EQ(network.getPopulation().getNbSpikes(neuron) > 0, true);
+		previousTime = time;
+		previousNeuron = neuron;
+		++nLines;
+	}
+	EXPECT_EQ(nLines, nSpikes);
+	std::remove(config.output.c_str());
+}
+
+TEST(NetworkTest, SameNetworkOnAnyNumberOfThreads) {
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.backgroundNoise = true;
+	config.duration = 300;
+	config.verbose = false;
+	config.streamSpikes = false;
+	
+	Current current(0.0, 0, 0);
+	config.nThreads = 1;
+	Network reference(&current, config);
+	reference.run();
+	
+	for (int nThreads : { 2, 3 }) {
+		config.nThreads = nThreads;
+		Network network(&current, config);
+		network.run();
+		
+		// same connections
+		for (int i = 0; i < config.getNbNeurons(); ++i) {
+			auto expected = reference.getSynapses().getTargets(i), actual = network.getSynapses().getTargets(i);
+			ASSERT_EQ(actual, expected);
+		}
+		
+		// same spikes
+		for (int i = 0; i < config.getNbNeurons(); ++i) {
+			ASSERT_EQ(network.getPopulation().getSpikeTimes(i), reference.getPopulation().getSpikeTimes(i)) << nThreads << " threads";
+			ASSERT_EQ(network.getStatistics().getNbSpikes(i), (long) reference.getPopulation().getSpikeTimes(i).size());
+		}
+		EXPECT_EQ(network.getStatistics().getRates(), reference.getStatistics().getRates());
+	}
+	
+	// every spike reaches all targets of its neuron
+	long events = 0;
+	for (int i = 0; i < config.getNbNeurons(); ++i) {
+		events += reference.getPopulation().getNbSpikes(i) * (long) reference.getSynapses().getTargets(i).size();
+	}
+	EXPECT_EQ(reference.getNbSynapticEvents(), events);
+	EXPECT_GT(events, 0);
+	
+	// the statistics do not need the spikes
+	config.recordSpikes = false;
+	Network unrecorded(&current, config);
+	unrecorded.run();
+	EXPECT_TRUE(unrecorded.getPopulation().getSpikeTimes(0).empty());
+	EXPECT_EQ(unrecorded.getStatistics().getNbSpikes(), reference.getStatistics().getNbSpikes());
+	EXPECT_GT(unrecorded.getStatistics().getNbSpikes(), 0);
+	config.recordSpikes = true;
+	
+	// procedural connections do not depend on the number of threads either
+	config.proceduralConnections = true;
+	config.nThreads = 1;
+	Network procedural(&current, config);
+	procedural.run();
+	config.nThreads = 3;
+	Network parallel(&current, config);
+	parallel.run();
+	
+	ProceduralConnections connections(config.getNbNeurons(), config.epsilon, config.seed);
+	events = 0;
+	for (int i = 0; i < config.getNbNeurons(); ++i) {
+		ASSERT_EQ(parallel.getPopulation().getSpikeTimes(i), procedural.getPopulation().getSpikeTimes(i));
+		events += procedural.getPopulation().getNbSpikes(i) * (long) connections.getTargets(i).size();
+	}
+	EXPECT_EQ(procedural.getNbSynapticEvents(), events);
+	config.proceduralConnections = false;
+	
+	// the connections depend on the seed
+	config.seed += 1;
+	auto other = Network::createSynapses(config);
+	EXPECT_EQ(other->getNbSynapses(), reference.getSynapses().getNbSynapses());
+	bool isSame = true;
+	for (int i = 0; i < config.getNbNeurons() && isSame; ++i) {
+		isSame = other->getTargets(i).size() == reference.getSynapses().getTargets(i).size();
+	}
+	EXPECT_FALSE(isSame);
+}
+
+TEST(CheckpointTest, ResumesExactly) {
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.backgroundNoise = true;
+	config.duration = 300;
+	config.verbose = false;
+	config.streamSpikes = false;
+	
+	Current current(0.0, 0, 0);
+	Network reference(&current, config);
+	reference.run();
+	
+	// stop at step 130, with checkpoints on the way, and resume on another number of threads
+	config.duration = 130;
+	config.checkpoint = "checkpoint_test.bin";
+	config.checkpointInterval = 50;
+	Network stopped(&current, config);
+	stopped.run();
+	
+	config.duration = 300;
+	config.checkpoint = "";
+	config.nThreads = 3;
+	Network resumed(&current, config);
+	resumed.restore("checkpoint_test.bin");
+	resumed.run();
+	
+	for (int i = 0; i < config.getNbNeurons(); ++i) {
+		ASSERT_EQ(resumed.getPopulation().getSpikeTimes(i), reference.getPopulation().getSpikeTimes(i));
+		ASSERT_EQ(resumed.getPopulation().getPotential(i), reference.getPopulation().getPotential(i));
+		ASSERT_EQ(resumed.getStatistics().getIsiCv(i), reference.getStatistics().getIsiCv(i));
+	}
+	EXPECT_EQ(resumed.getStatistics().getRates(), reference.getStatistics().getRates());
+	
+	// only the same model can resume
+	config.g += 1.0;
+	Network other(&current, config);
+	EXPECT_THROW(other.restore("checkpoint_test.bin"), std::runtime_error);
+	config.g -= 1.0;
+	
+	// streamed files are cut back to the checkpoint and continued
+	config.streamSpikes = true;
+	config.output = "checkpoint_test.spikes";
+	for (const char* format : { "gdf", "binary" }) {
+		config.format = format;
+		auto read = [&]() {
+			std::ifstream in(config.output, std::ios::binary);
+			std::stringstream data;
+			data << in.rdbuf();
+			return data.str();
+		};
+		
+		config.nThreads = 1;
+		config.duration = 300;
+		Network whole(&current, config);
+		whole.run();
+		const std::string expected = read();
+		
+		config.checkpoint = "checkpoint_test.bin";
+		config.duration = 100;
+		Network first(&current, config);
+		first.run();
+		
+		std::ifstream in(config.checkpoint, std::ios::binary);
+		std::stringstream saved;
+		saved << in.rdbuf();
+		in.close();
+		
+		// runs on after the checkpoint, then stops
+		config.duration = 200;
+		Network lost(&current, config);
+		lost.restore(config.checkpoint);
+		lost.run();
+		
+		std::ofstream(config.checkpoint, std::ios::binary) << saved.str();
+		config.duration = 300;
+		config.nThreads = 2;
+		Network last(&current, config);
+		last.restore(config.checkpoint);
+		last.run();
+		
+		if (config.format == "gdf") {
+			EXPECT_EQ(read(), expected);
+		} else {
+			const std::vector<Spike> spikes = SpikeReader(config.output).read();
+			std::string text;
+			for (const Spike& spike : spikes) {
+				text += std::to_string(spike.time) + "\t" + std::to_string(spike.neuron) + "\n";
+			}
+			EXPECT_EQ(SpikeReader(config.output).getEnd(), 300);
+			
+			std::ofstream(config.output, std::ios::binary) << expected;
+			std::string reference;
+			for (const Spike& spike : SpikeReader(config.output).read()) {
+				reference += std::to_string(spike.time) + "\t" + std::to_string(spike.neuron) + "\n";
+			}
+			EXPECT_EQ(text, reference);
+		}
+		config.checkpoint = "";
+	}
+	
+	std::remove("checkpoint_test.bin");
+	std::remove(config.output.c_str());
+}
+
+TEST(DistributedTest, SameSpikesAsOneProcess) {
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.backgroundNoise = true;
+	config.duration = 300;
+	config.verbose = false;
+	config.streamSpikes = false;
+	
+	Current current(0.0, 0, 0);
+	Network reference(&current, config);
+	reference.run();
+	
+	// every rank of a group in a thread of its own, each one with several threads
+	config.nThreads = 2;
+	for (bool isProcedural : { false, true }) {
+		config.proceduralConnections = isProcedural;
+		Network single(&current, config);
+		single.run();
+		
+		// the second group generates the noise of every rank on a producer thread
+		config.noiseProducer = isProcedural;
+		auto transports = LocalTransport::createGroup(3);
+		std::vector<std::unique_ptr<Network>> ranks(3);
+		std::vector<std::thread> threads;
+		for (int rank = 0; rank < 3; ++rank) {
+			threads.emplace_back([&, rank]() {
+				ranks[rank].reset(new Network(&current, config, *transports[rank]));
+				ranks[rank]->run();
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		
+		// every rank knows all spikes
+		for (int rank = 0; rank < 3; ++rank) {
+			for (int i = 0; i < config.getNbNeurons(); ++i) {
+				ASSERT_EQ(ranks[rank]->getPopulation().getSpikeTimes(i), single.getPopulation().getSpikeTimes(i)) << rank;
+			}
+			EXPECT_EQ(ranks[rank]->getStatistics().getRates(), single.getStatistics().getRates());
+		}
+		
+		// and the potentials of its own neurons, the only ones it keeps
+		const std::pair<int, int> range = Network::getRange(config.getNbNeurons(), 1, 3);
+		EXPECT_GT(range.first, 0);
+		EXPECT_EQ(ranks[1]->getPopulation().getFirst(), range.first);
+		EXPECT_EQ(ranks[1]->getPopulation().getLast(), range.second);
+		for (int i = range.first; i < range.second; ++i) {
+			ASSERT_EQ(ranks[1]->getPopulation().getPotential(i), single.getPopulation().getPotential(i));
+		}
+	}
+	config.proceduralConnections = false;
+	config.noiseProducer = false;
+	
+	// two ranks connected by a socket write the same file as one process
+	config.streamSpikes = true;
+	config.output = "distributed_test.gdf";
+	config.nThreads = 1;
+	Network streamed(&current, config);
+	streamed.run();
+	
+	std::ifstream in(config.output);
+	std::stringstream expected;
+	expected << in.rdbuf();
+	in.close();
+	std::remove(config.output.c_str());
+	
+	std::vector<std::thread> threads;
+	for (int rank = 0; rank < 2; ++rank) {
+		threads.emplace_back([&, rank]() {
+			SocketTransport transport("distributed_test.sock", rank, 2, 10);
+			Network network(&current, config, transport);
+			network.run();
+			network.save();
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	
+	in.open(config.output);
+	std::stringstream actual;
+	actual << in.rdbuf();
+	std::remove(config.output.c_str());
+	
+	EXPECT_GT(expected.str().size(), 0u);
+	EXPECT_EQ(actual.str(), expected.str());
+	
+	// a rank which loses the others, or receives an invalid epoch, stops all its threads and reports it
+	struct Faulty : Transport {
+		int fault = -1, nNeurons = 0;
+		virtual int getRank() const override { return 0; }
+		virtual int size() const override { return 2; }
+		virtual void allGather(const std::vector<int32_t>& data, std::vector<std::vector<int32_t>>& all) override {
+			all.assign(2, std::vector<int32_t>());
+			all[0] = data;
+			
+			// as many steps as this rank, without spikes
+			std::vector<int32_t>& other = all[1];
+			for (std::size_t position = 0; position < data.size(); position += data[position] + 1) {
+				other.push_back(0);
+			}
+			const std::size_t nSteps = other.size();
+			
+			if (fault == 0) other.clear();
+			if (fault == 1) other.pop_back();
+			if (fault == 2) other.push_back(0);
+			
+			// spikes in the first step of a neuron of this rank, of decreasing neurons, of no neuron
+			if (fault == 3) other.insert(other.begin() + 1, 0);
+			if (fault == 4) other.insert(other.begin() + 1, { nNeurons - 1, nNeurons - 2 });
+			if (fault == 5) other.insert(other.begin() + 1, nNeurons);
+			if (fault >= 3) other[0] = other.size() - nSteps;
+		}
+	} faulty;
+	faulty.nNeurons = config.getNbNeurons();
+	config.streamSpikes = false;
+	config.nThreads = 2;
+	for (int fault = -1; fault <= 5; ++fault) {
+		faulty.fault = fault;
+		Network alone(&current, config, faulty);
+		if (fault < 0) {
+			EXPECT_NO_THROW(alone.run());
+		} else {
+			EXPECT_THROW(alone.run(), std::runtime_error) << fault;
+		}
+	}
+	
+	EXPECT_THROW(SocketTransport("distributed_test.sock", 1, 2, 0), std::runtime_error);
+}
+
+TEST(SweepTest, GridsAndSharedConnections) {
+	EXPECT_EQ(Sweep::parseGrid("1:2:0.5"), std::vector<double>({ 1.0, 1.5, 2.0 }));
+	EXPECT_EQ(Sweep::parseGrid("0.9,2,4"), std::vector<double>({ 0.9, 2.0, 4.0 }));
+	EXPECT_THROW(Sweep::parseGrid("1:2"), std::invalid_argument);
+	EXPECT_THROW(Sweep::parseGrid("1,x"), std::invalid_argument);
+	
+	Config config;
+	config.nExcitatory = 800;
+	config.nInhibitory = 200;
+	config.backgroundNoise = true;
+	config.duration = 300;
+	config.nThreads = 3;
+	config.verbose = false;
+	config.statistics = "sweep_test.txt";
+	
+	// the same point twice gives the same result, on the shared connections
+	Sweep sweep(config, { 2.0, 2.0 }, { 5.0, 3.0 });
+	sweep.run(false);
+	
+	// every point writes its own statistics
+	for (const char* filename : { "sweep_test_eta2_g5.txt", "sweep_test_eta2_g3.txt" }) {
+		std::ifstream in(filename);
+		EXPECT_TRUE(in.good()) << filename;
+		std::remove(filename);
+	}
+	
+	const std::vector<Sweep::Point>& points = sweep.getPoints();
+	ASSERT_EQ(points.size(), 4u);
+	EXPECT_EQ(points[1].g, 3.0);
+	EXPECT_GT(points[0].nSpikes, 0);
+	EXPECT_EQ(points[0].nSpikes, points[2].nSpikes);
+	EXPECT_EQ(points[1].nSpikes, points[3].nSpikes);
+	EXPECT_EQ(points[0].activityCv, points[2].activityCv);
+	EXPECT_NE(points[0].nSpikes, points[1].nSpikes);
+	EXPECT_DOUBLE_EQ(points[0].rate, points[0].nSpikes / (1000 * 300 * C::STEP_DURATION));
+}
+
 
 int main(int argc, char**argv) {
 	::testing::InitGoogleTest(&argc, argv);